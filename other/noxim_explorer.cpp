@@ -7,7 +7,10 @@
 #include <string>
 #include <cassert>
 #include <cstdlib>
+#include <cstdio>
+#include <unistd.h>
 #include <sys/time.h>
+#include <sys/wait.h>
 
 using namespace std;
 
@@ -70,6 +73,17 @@ struct TSimulationResults
   unsigned int rflits;
 };
 
+// One run of the simulator. Jobs are numbered in the order their rows
+// appear in the output files, whatever the order they complete in
+struct TSimulationJob
+{
+  string             cmd;
+  string             tmp_fname; // Output of the simulator, unique to the job
+  uint               aggr;      // Index of the aggregated configuration
+  bool               done;
+  TSimulationResults sres;
+};
+
 //---------------------------------------------------------------------------
 
 double GetCurrentTime()
@@ -83,6 +97,8 @@ double GetCurrentTime()
 
 //---------------------------------------------------------------------------
 
+// The simulations completed so far by all the workers give the rate at
+// which the remaining ones will be completed
 void TimeToFinish(double elapsed_sec,
 		  int completed, int total,
 		  int& hours, int& minutes, int &seconds)
@@ -609,22 +625,50 @@ bool ReadResults(const string& fname,
 
 //---------------------------------------------------------------------------
 
-bool RunSimulation(const string& cmd_base,
-		   const string& tmp_dir,
-		   TSimulationResults& sres, 
-		   string& error_msg)
+string MakeTmpFileName(const string& tmp_dir, const uint job)
 {
-  string tmp_fname = tmp_dir + TMP_FILE_NAME;
-  //  string cmd = cmd_base + " >& " + tmp_fname; // this works only with csh and bash
-  string cmd = cmd_base + " >" + tmp_fname + " 2>&1"; // this works with sh, csh, and bash!
+  // Unique to the job and to this explorer, so that several explorers can
+  // share the same tmp directory
+  ostringstream oss;
+  oss << tmp_dir << TMP_FILE_NAME << "." << getpid() << "." << job;
+
+  return oss.str();
+}
+
+//---------------------------------------------------------------------------
+
+pid_t StartSimulation(const TSimulationJob& job,
+		      string& error_msg)
+{
+  //  string cmd = job.cmd + " >& " + job.tmp_fname; // this works only with csh and bash
+  string cmd = job.cmd + " >" + job.tmp_fname + " 2>&1"; // this works with sh, csh, and bash!
 
   cout << cmd << endl;
-  system(cmd.c_str());
-  if (!ReadResults(tmp_fname, sres, error_msg))
+  cout.flush();
+
+  pid_t pid = fork();
+  if (pid == 0)
+    {
+      execl("/bin/sh", "sh", "-c", cmd.c_str(), (char*)NULL);
+      _exit(127);
+    }
+
+  if (pid < 0)
+    error_msg = "Cannot start " + job.cmd;
+
+  return pid;
+}
+
+//---------------------------------------------------------------------------
+
+bool FinishSimulation(TSimulationJob& job,
+		      string& error_msg)
+{
+  if (!ReadResults(job.tmp_fname, job.sres, error_msg))
     return false;
 
-  string rm_cmd = string("rm -f ") + tmp_fname;
-  system(rm_cmd.c_str());
+  remove(job.tmp_fname.c_str());
+  job.done = true;
 
   return true;
 }
@@ -644,46 +688,24 @@ string ExtractFirstField(const string& s)
 
 //---------------------------------------------------------------------------
 
-bool RunSimulations(double start_time,
-		    pair<uint,uint>& sim_counter,
-		    const string& cmd, const string& tmp_dir, const int repetitions,
-		    const TConfiguration& aggr_conf, 
-		    ofstream& fout, 
-		    string& error_msg)
+void PrintResults(const TConfiguration& aggr_conf, 
+		  const TSimulationResults& sres,
+		  ofstream& fout)
 {
-  int    h, m, s;
-  
-  for (int i=0; i<repetitions; i++)
-    {
-      cout << "# simulation " << (++sim_counter.first) << " of " << sim_counter.second;
-      if (i != 0)
-	cout << ", estimated time to finish " << h << "h " << m << "m " << s << "s";
-      cout << endl;
-
-      TSimulationResults sres;
-      if (!RunSimulation(cmd, tmp_dir, sres, error_msg))
-	return false;
-
-      double current_time = GetCurrentTime();
-      TimeToFinish(current_time-start_time, sim_counter.first, sim_counter.second, h, m, s);
-
-      // Print aggragated parameters
-      fout << "  ";
-      for (uint i=0; i<aggr_conf.size(); i++)
-	fout << setw(MATRIX_COLUMN_WIDTH) << ExtractFirstField(aggr_conf[i].second); // this fix the problem with pir
-      // fout << setw(MATRIX_COLUMN_WIDTH) << aggr_conf[i].second;
-
-      // Print results;
-      fout << setw(MATRIX_COLUMN_WIDTH) << sres.avg_delay
-	   << setw(MATRIX_COLUMN_WIDTH) << sres.throughput
-	   << setw(MATRIX_COLUMN_WIDTH) << sres.max_delay
-	   << setw(MATRIX_COLUMN_WIDTH) << sres.total_energy
-	   << setw(MATRIX_COLUMN_WIDTH) << sres.rpackets
-	   << setw(MATRIX_COLUMN_WIDTH) << sres.rflits 
-	   << endl;
-    }
-
-  return true;
+  // Print aggragated parameters
+  fout << "  ";
+  for (uint i=0; i<aggr_conf.size(); i++)
+    fout << setw(MATRIX_COLUMN_WIDTH) << ExtractFirstField(aggr_conf[i].second); // this fix the problem with pir
+  // fout << setw(MATRIX_COLUMN_WIDTH) << aggr_conf[i].second;
+
+  // Print results;
+  fout << setw(MATRIX_COLUMN_WIDTH) << sres.avg_delay
+       << setw(MATRIX_COLUMN_WIDTH) << sres.throughput
+       << setw(MATRIX_COLUMN_WIDTH) << sres.max_delay
+       << setw(MATRIX_COLUMN_WIDTH) << sres.total_energy
+       << setw(MATRIX_COLUMN_WIDTH) << sres.rpackets
+       << setw(MATRIX_COLUMN_WIDTH) << sres.rflits 
+       << endl;
 }
 
 //---------------------------------------------------------------------------
@@ -796,10 +818,46 @@ bool PrintMatlabVariableEnd(const int repetitions,
 
 //---------------------------------------------------------------------------
 
+bool WriteConfiguration(const TConfiguration&     conf,
+			const TExplorerParams&    eparams,
+			const string&             def_cmd_line,
+			const TParametersSpace&   aggragated_params_space,
+			const TConfigurationSpace& aggr_conf_space,
+			const TSimulationJob*     jobs,
+			string&                   error_msg)
+{
+  string conf_cmd_line = Configuration2CmdLine(conf);
+
+  string   mfname = Configuration2FunctionName(conf);
+  string   fname  = mfname + ".m";
+  ofstream fout;
+  if (!PrintHeader(fname, eparams, 
+		   def_cmd_line, conf_cmd_line, fout, error_msg))
+    return false;
+
+  if (!PrintMatlabFunction(mfname, fout, error_msg))
+    return false;
+
+  if (!PrintMatlabVariableBegin(aggragated_params_space, fout, error_msg))
+    return false;
+
+  uint njobs = aggr_conf_space.size() * eparams.repetitions;
+  for (uint j=0; j<njobs; j++)
+    PrintResults(aggr_conf_space[jobs[j].aggr], jobs[j].sres, fout);
+
+  if (!PrintMatlabVariableEnd(eparams.repetitions, fout, error_msg))
+    return false;
+
+  return true;
+}
+
+//---------------------------------------------------------------------------
+
 bool RunSimulations(const TConfigurationSpace& conf_space,
 		    const TParameterSpace&     default_params,
 		    const TParametersSpace&    aggragated_params_space,
 		    const TParameterSpace&     explorer_params,
+		    const int                  max_workers,
 		    string&                    error_msg)
 {
   TExplorerParams eparams;
@@ -814,26 +872,12 @@ bool RunSimulations(const TConfigurationSpace& conf_space,
   // Explore configuration space
   TConfigurationSpace aggr_conf_space = Explore(aggragated_params_space);
 
-  pair<uint,uint> sim_counter(0, conf_space.size() * aggr_conf_space.size() * eparams.repetitions);
-  
-  double start_time = GetCurrentTime();
+  // Every simulation of every configuration, in the order of the rows
+  vector<TSimulationJob> jobs;
   for (uint i=0; i<conf_space.size(); i++)
     {
       string conf_cmd_line = Configuration2CmdLine(conf_space[i]);
 
-      string   mfname = Configuration2FunctionName(conf_space[i]);
-      string   fname  = mfname + ".m";
-      ofstream fout;
-      if (!PrintHeader(fname, eparams, 
-		       def_cmd_line, conf_cmd_line, fout, error_msg))
-	return false;
-
-      if (!PrintMatlabFunction(mfname, fout, error_msg))
-	return false;
-
-      if (!PrintMatlabVariableBegin(aggragated_params_space, fout, error_msg))
-	return false;
-
       for (uint j=0; j<aggr_conf_space.size(); j++)
 	{
 	  string aggr_cmd_line = Configuration2CmdLine(aggr_conf_space[j]);
@@ -843,27 +887,106 @@ bool RunSimulations(const TConfigurationSpace& conf_space,
 	    + conf_cmd_line + " "
 	    + aggr_cmd_line;
 	  */
-	  string cmd = eparams.simulator + " "
+	  TSimulationJob job;
+	  job.cmd = eparams.simulator + " "
             + aggr_cmd_line + " "
 	    + def_cmd_line + " "
 	    + conf_cmd_line;
+	  job.aggr = j;
+	  job.done = false;
 
-	  if (!RunSimulations(start_time,
-			      sim_counter, cmd, eparams.tmp_dir, eparams.repetitions,
-			      aggr_conf_space[j], fout, error_msg))
-	    return false;
+	  for (int k=0; k<eparams.repetitions; k++)
+	    {
+	      job.tmp_fname = MakeTmpFileName(eparams.tmp_dir, jobs.size());
+	      jobs.push_back(job);
+	    }
 	}
+    }
 
-      if (!PrintMatlabVariableEnd(eparams.repetitions, fout, error_msg))
-	return false;
+  uint jobs_per_conf = aggr_conf_space.size() * eparams.repetitions;
+  uint next_job = 0, completed = 0, written_confs = 0;
+  map<pid_t, uint> running; // worker, job
+  bool ok = true;
+  int  h = 0, m = 0, s = 0;
+  
+  double start_time = GetCurrentTime();
+  while (ok || !running.empty())
+    {
+      // Keep every worker busy
+      while (ok && next_job < jobs.size() && (int)running.size() < max_workers)
+	{
+	  cout << "# simulation " << (next_job + 1) << " of " << jobs.size();
+	  if (completed != 0)
+	    cout << ", estimated time to finish " << h << "h " << m << "m " << s << "s";
+	  cout << endl;
+
+	  pid_t pid = StartSimulation(jobs[next_job], error_msg);
+	  if (pid < 0)
+	    ok = false;
+	  else
+	    running[pid] = next_job++;
+	}
+
+      if (running.empty())
+	break;
+
+      // Wait for any worker: results come out of order
+      int   status;
+      pid_t pid = waitpid(-1, &status, 0);
+      if (pid < 0)
+	{
+	  error_msg = "Lost track of the simulations";
+	  return false;
+	}
+
+      map<pid_t, uint>::iterator it = running.find(pid);
+      if (it == running.end())
+	continue;
+
+      TSimulationJob& job = jobs[it->second];
+      running.erase(it);
+
+      // Keep the first error, but let the running simulations complete
+      string job_error;
+      if (!FinishSimulation(job, job_error))
+	{
+	  if (ok)
+	    error_msg = job_error;
+	  ok = false;
+	  continue;
+	}
+
+      completed++;
+      double current_time = GetCurrentTime();
+      TimeToFinish(current_time-start_time, completed, jobs.size(), h, m, s);
+
+      // Output files of the configurations whose simulations are all
+      // done, in order
+      while (ok && written_confs < conf_space.size())
+	{
+	  uint first = written_confs * jobs_per_conf;
+	  bool conf_done = true;
+	  for (uint j=first; j<first+jobs_per_conf && conf_done; j++)
+	    conf_done = jobs[j].done;
+
+	  if (!conf_done)
+	    break;
+
+	  if (!WriteConfiguration(conf_space[written_confs], eparams, def_cmd_line,
+				  aggragated_params_space, aggr_conf_space,
+				  jobs_per_conf > 0 ? &jobs[first] : NULL, error_msg))
+	    ok = false;
+	  written_confs++;
+	}
     }
 
-  return true;
+  return ok;
 }
 
 //---------------------------------------------------------------------------
 
 bool RunSimulations(const string& script_fname,
+		    const int     max_workers,
 		    string&       error_msg)
 {
   TParametersSpace ps;
@@ -893,7 +1016,8 @@ bool RunSimulations(const string& script_fname,
   TConfigurationSpace conf_space = Explore(ps);
 
   if (!RunSimulations(conf_space, default_params, 
-		      aggragated_params_space, explorer_params, error_msg))
+		      aggragated_params_space, explorer_params, max_workers,
+		      error_msg))
     return false;
 
 
@@ -905,20 +1029,33 @@ bool RunSimulations(const string& script_fname,
 
 int main(int argc, char **argv)
 {
-  if (argc < 2)
+  int max_workers = 1;
+  int first_cfg   = 1;
+
+  // -j N: up to N simulations at the same time, 0 for one per processor
+  if (argc > 2 && string(argv[1]) == "-j")
+    {
+      max_workers = atoi(argv[2]);
+      if (max_workers == 0)
+	max_workers = sysconf(_SC_NPROCESSORS_ONLN);
+      first_cfg = 3;
+    }
+
+  if (argc <= first_cfg || max_workers < 1)
     {
-      cout << "Usage: " << argv[0] << " <cfg file> [<cfg file>]" << endl;
+      cout << "Usage: " << argv[0] << " [-j N] <cfg file> [<cfg file>]" << endl
+	   << "  -j N  run up to N simulations at the same time (0 for one per processor)" << endl;
       return -1;
     }
 
-  for (int i=1; i<argc; i++)
+  for (int i=first_cfg; i<argc; i++)
     {
       string fname(argv[i]);
       cout << "# Exploring configuration space " << fname << endl;
 
       string error_msg;
 
-      if (!RunSimulations(fname, error_msg))
+      if (!RunSimulations(fname, max_workers, error_msg))
 	cout << "Error: " << error_msg << endl;
 
       cout << endl;
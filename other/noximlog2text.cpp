@@ -0,0 +1,100 @@
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+
+#include "../src/NoximEventLog.h"
+
+using namespace std;
+
+// ---------------------------------------------------------------------------
+// Converts a binary event log written by noxim -log into the text lines
+// the simulator used to print on the standard output
+
+void PrintRecord(const NoximLogRecord& record, bool show_cycles)
+{
+  if (show_cycles)
+    cout << record.cycle << ": ";
+
+  switch (record.type)
+    {
+    case EVENT_PACKET_STATE:
+      cout << "########STATE" << record.id << ":" << record.value << endl;
+      break;
+
+    case EVENT_PACKET_CREATED:
+      cout << "PE..ID" << record.id << ",IndexID" << record.value << endl;
+      break;
+
+    case EVENT_PACKET_SENT:
+      cout << "PACKETID" << record.id << "------------DESTINATION ID"
+	   << record.value << endl;
+      break;
+
+    case EVENT_NO_PATH:
+      cout << "NoPath------------" << record.value << endl;
+      break;
+
+    default:
+      cout << "unknown event " << record.type << " (" << record.id << ", "
+	   << record.value << ")" << endl;
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  bool  show_cycles = false;
+  char* fname = NULL;
+
+  for (int i=1; i<argc; i++)
+    {
+      if (!strcmp(argv[i], "-cycles"))
+	show_cycles = true;
+      else
+	fname = argv[i];
+    }
+
+  if (fname == NULL)
+    {
+      cerr << "Usage: " << argv[0] << " [-cycles] LOGFILE" << endl
+	   << "  -cycles  prefix each line with the cycle of the event" << endl;
+      return 1;
+    }
+
+  FILE* fin = fopen(fname, "rb");
+  if (fin == NULL)
+    {
+      cerr << "Cannot open " << fname << endl;
+      return 1;
+    }
+
+  char         magic[sizeof(LOG_MAGIC)] = "";
+  unsigned int version = 0;
+
+  if (fread(magic, strlen(LOG_MAGIC), 1, fin) != 1 ||
+      strcmp(magic, LOG_MAGIC) != 0 ||
+      fread(&version, sizeof(version), 1, fin) != 1)
+    {
+      cerr << fname << " is not a noxim event log" << endl;
+      return 1;
+    }
+
+  if (version != LOG_VERSION)
+    {
+      cerr << fname << ": unsupported log version " << version << endl;
+      return 1;
+    }
+
+  NoximLogRecord records[1024];
+  size_t         n;
+
+  while ((n = fread(records, sizeof(NoximLogRecord), 1024, fin)) > 0)
+    for (size_t i=0; i<n; i++)
+      PrintRecord(records[i], show_cycles);
+
+  fclose(fin);
+
+  return 0;
+}
@@ -0,0 +1,160 @@
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+#include "../src/NoximPacketTrace.h"
+
+using namespace std;
+
+// ---------------------------------------------------------------------------
+// Decodes a packet trace written by noxim -packet_trace: prints the
+// timeline of every packet, or the use of every link by the head flits
+
+// Same numbering as the DIRECTION_* constants of the simulator
+const char* DirectionName(int direction)
+{
+  static const char* names[] = { "N", "E", "S", "W", "L" };
+
+  if (direction < 0 || direction > 4)
+    return "?";
+
+  return names[direction];
+}
+
+// ---------------------------------------------------------------------------
+
+void PrintTimeline(int packet_id, const vector<NoximTraceRecord>& events)
+{
+  cout << "packet " << packet_id << ":";
+
+  for (size_t i=0; i<events.size(); i++)
+    {
+      const NoximTraceRecord& record = events[i];
+
+      cout << " " << record.cycle << ":";
+      switch (record.type)
+	{
+	case TRACE_INJECT:
+	  cout << "inject " << record.router << "->" << record.value;
+	  break;
+
+	case TRACE_HOP:
+	  cout << record.router << DirectionName(record.direction);
+	  break;
+
+	case TRACE_DELIVER:
+	  cout << "deliver " << record.router;
+	  break;
+
+	case TRACE_NO_PATH:
+	  cout << "nopath " << record.router;
+	  break;
+
+	case TRACE_EJECT:
+	  cout << "eject " << record.router;
+	  break;
+
+	default:
+	  cout << "unknown" << (int)record.type;
+	}
+    }
+
+  cout << endl;
+}
+
+// ---------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  bool  show_links = false;
+  char* fname = NULL;
+
+  for (int i=1; i<argc; i++)
+    {
+      if (!strcmp(argv[i], "-links"))
+	show_links = true;
+      else
+	fname = argv[i];
+    }
+
+  if (fname == NULL)
+    {
+      cerr << "Usage: " << argv[0] << " [-links] TRACEFILE" << endl
+	   << "  -links  print the head flits crossing each link instead of the packet timelines" << endl;
+      return 1;
+    }
+
+  FILE* fin = fopen(fname, "rb");
+  if (fin == NULL)
+    {
+      cerr << "Cannot open " << fname << endl;
+      return 1;
+    }
+
+  NoximTraceHeader header;
+
+  if (fread(&header, sizeof(header), 1, fin) != 1 ||
+      strncmp(header.magic, TRACE_MAGIC, sizeof(header.magic)) != 0)
+    {
+      cerr << fname << " is not a noxim packet trace" << endl;
+      return 1;
+    }
+
+  if (header.version != TRACE_VERSION ||
+      header.record_size != sizeof(NoximTraceRecord))
+    {
+      cerr << fname << ": unsupported trace version " << header.version << endl;
+      return 1;
+    }
+
+  // Read the slots in use, then start from the oldest record
+  unsigned long long used = header.written;
+  unsigned long long first = 0;
+
+  if (header.written > header.capacity)
+    {
+      used = header.capacity;
+      first = header.written % header.capacity;
+      cerr << "Warning: " << header.written - header.capacity
+	   << " older records have been overwritten" << endl;
+    }
+
+  vector<NoximTraceRecord> slots(used);
+
+  if (used > 0 && fread(&slots[0], sizeof(NoximTraceRecord), used, fin) != used)
+    {
+      cerr << fname << ": truncated trace" << endl;
+      return 1;
+    }
+  fclose(fin);
+
+  map<int, vector<NoximTraceRecord> > packets;
+  map<pair<int, int>, unsigned long> links;
+
+  for (unsigned long long k=0; k<used; k++)
+    {
+      const NoximTraceRecord& record = slots[(first + k) % used];
+
+      packets[record.packet_id].push_back(record);
+      if (record.type == TRACE_HOP)
+	links[make_pair((int)record.router, (int)record.direction)]++;
+    }
+
+  if (show_links)
+    {
+      cout << "% router direction head_flits" << endl;
+      for (map<pair<int, int>, unsigned long>::iterator it = links.begin();
+	   it != links.end(); it++)
+	cout << it->first.first << " " << DirectionName(it->first.second)
+	     << " " << it->second << endl;
+    }
+  else
+    for (map<int, vector<NoximTraceRecord> >::iterator it = packets.begin();
+	 it != packets.end(); it++)
+      PrintTimeline(it->first, it->second);
+
+  return 0;
+}
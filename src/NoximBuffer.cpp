@@ -10,18 +10,23 @@
 
 #include "NoximBuffer.h"
 
+// Slots allocated up front for each buffer
+#define INITIAL_BUFFER_CAPACITY 16
+
 NoximBuffer::NoximBuffer()
 {
   SetMaxBufferSize(DEFAULT_BUFFER_DEPTH);
-  max_occupancy = 0;
-  hold_time = 0.0;
-  last_event = 0.0;
-  hold_time_sum = 0.0;
-  previous_occupancy = 0;
-  mean_occupancy = 0.0;
+  ResetStats();
   true_buffer = true;
 }
 
+void NoximBuffer::ResetStats()
+{
+  max_occupancy = 0;
+  occupancy_sum = 0;
+  samples = 0;
+}
+
 void NoximBuffer::Disable()
 {
   true_buffer = false;
@@ -32,24 +37,32 @@ void NoximBuffer::SetMaxBufferSize(const unsigned int bms)
   assert(bms > 0);
 
   max_buffer_size = bms;
-}
 
-unsigned int NoximBuffer::GetMaxBufferSize() const
-{
-  return max_buffer_size;
-}
+  // Start small: the default depth is far larger than what the
+  // buffers usually hold
+  unsigned int capacity = 1;
+  while (capacity < bms && capacity < INITIAL_BUFFER_CAPACITY)
+    capacity <<= 1;
 
-bool NoximBuffer::IsFull() const
-{
-  return buffer.size() == max_buffer_size;
+  slots.assign(capacity, 0);
+  mask = capacity - 1;
+  head = 0;
+  count = 0;
 }
 
-bool NoximBuffer::IsEmpty() const
+void NoximBuffer::Grow()
 {
-  return buffer.size() == 0;
+  vector < NoximFlitHandle > larger(slots.size() * 2);
+
+  for (unsigned int i = 0; i < count; i++)
+    larger[i] = slots[(head + i) & mask];
+
+  slots.swap(larger);
+  mask = slots.size() - 1;
+  head = 0;
 }
 
-void NoximBuffer::Drop(const NoximFlit & flit) const
+void NoximBuffer::Drop(const NoximFlitHandle flit) const
 {
   assert(false);
 }
@@ -59,84 +72,78 @@ void NoximBuffer::Empty() const
   assert(false);
 }
 
-void NoximBuffer::Push(const NoximFlit & flit)
+void NoximBuffer::Push(const NoximFlitHandle flit)
 {
-  SaveOccupancyAndTime();
-
-  if (IsFull())
+  if (IsFull()) {
     Drop(flit);
-  else
-    buffer.push(flit);
-  
-  UpdateMeanOccupancy();
-
-  if (max_occupancy < buffer.size())
-    max_occupancy = buffer.size();
-}
-
-NoximFlit NoximBuffer::Pop()
-{
-  NoximFlit f;
-
-  SaveOccupancyAndTime();
-
-  if (IsEmpty())
-    Empty();
-  else {
-    f = buffer.front();
-    buffer.pop();
+    return;
   }
 
-  UpdateMeanOccupancy();
+  if (count == slots.size())
+    Grow();
 
-  return f;
-}
-
-NoximFlit NoximBuffer::Front() const
-{
-  NoximFlit f;
-
-  if (IsEmpty())
-    Empty();
-  else
-    f = buffer.front();
+  slots[(head + count) & mask] = flit;
+  count++;
 
-  return f;
+  if (max_occupancy < count)
+    max_occupancy = count;
 }
 
-unsigned int NoximBuffer::Size() const
+void NoximBuffer::Pop()
 {
-  return buffer.size();
-}
+  if (IsEmpty()) {
+    Empty();
+    return;
+  }
 
-unsigned int NoximBuffer::getCurrentFreeSlots() const
-{
-  return (GetMaxBufferSize() - Size());
+  head++;
+  count--;
 }
 
-void NoximBuffer::SaveOccupancyAndTime()
+void NoximBuffer::SampleOccupancy(const int cycles)
 {
-  previous_occupancy = buffer.size();
-  hold_time = (sc_time_stamp().to_double() / 1000) - last_event;
-  last_event = sc_time_stamp().to_double() / 1000;
-}
+  // The current occupancy holds from now for 'cycles' cycles: only
+  // those past the warm-up are sampled
+  double first = max(getCurrentCycle(),
+		     (double) DEFAULT_RESET_TIME + NoximGlobalParams::stats_warm_up_time);
+  double end = getCurrentCycle() + cycles;
 
-void NoximBuffer::UpdateMeanOccupancy()
-{
-  double current_time = sc_time_stamp().to_double() / 1000;
-  if (current_time - DEFAULT_RESET_TIME < NoximGlobalParams::stats_warm_up_time)
+  if (first >= end)
     return;
 
-  mean_occupancy = mean_occupancy * (hold_time_sum/(hold_time_sum+hold_time)) +
-    (1.0/(hold_time_sum+hold_time)) * hold_time * buffer.size();
+  unsigned long sampled = (unsigned long) (end - first);
 
-  hold_time_sum += hold_time;
+  occupancy_sum += (unsigned long long) count * sampled;
+  samples += sampled;
 }
 
 void NoximBuffer::ShowStats(std::ostream & out)
 {
+  double mean_occupancy = (samples > 0) ? (double) occupancy_sum / samples : 0.0;
+
   if (true_buffer)
     out << "\t" << mean_occupancy << "\t" << max_occupancy;
   else
     out << "\t\t";
 }
+
+void NoximBuffer::checkpoint(NoximCheckpoint & cp)
+{
+  // Only the flits held are saved, oldest first
+  vector < NoximFlitHandle > held(count);
+
+  for (unsigned int i = 0; i < count; i++)
+    held[i] = slots[(head + i) & mask];
+
+  cp.transfer(held);
+
+  if (cp.isRestoring()) {
+    SetMaxBufferSize(max_buffer_size);
+    for (unsigned int i = 0; i < held.size() && !IsFull(); i++)
+      Push(held[i]);
+  }
+
+  cp.transfer(max_occupancy);
+  cp.transfer(occupancy_sum);
+  cp.transfer(samples);
+}
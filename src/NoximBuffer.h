@@ -12,10 +12,14 @@
 #define __NOXIMBUFFER_H__
 
 #include <cassert>
-#include <queue>
+#include <vector>
 #include "NoximMain.h"
+#include "NoximCheckpoint.h"
 using namespace std;
 
+// NoximBuffer -- input buffer of a router channel. The handles of the
+// flits are kept in a circular array whose capacity is a power of two,
+// doubled when full up to the buffer size.
 class NoximBuffer {
 
   public:
@@ -25,45 +29,66 @@ class NoximBuffer {
     virtual ~ NoximBuffer() {
     } void SetMaxBufferSize(const unsigned int bms);	// Set buffer max size (in flits)
 
-    unsigned int GetMaxBufferSize() const;	// Get max buffer size
+    unsigned int GetMaxBufferSize() const {	// Get max buffer size
+	return max_buffer_size;
+    }
 
-    unsigned int getCurrentFreeSlots() const;	// free buffer slots
+    unsigned int getCurrentFreeSlots() const {	// free buffer slots
+	return max_buffer_size - count;
+    }
 
-    bool IsFull() const;	// Returns true if buffer is full
+    bool IsFull() const {	// Returns true if buffer is full
+	return count == max_buffer_size;
+    }
 
-    bool IsEmpty() const;	// Returns true if buffer is empty
+    bool IsEmpty() const {	// Returns true if buffer is empty
+	return count == 0;
+    }
 
-    virtual void Drop(const NoximFlit & flit) const;	// Called by Push() when buffer is full
+    virtual void Drop(const NoximFlitHandle flit) const;	// Called by Push() when buffer is full
 
     virtual void Empty() const;	// Called by Pop() when buffer is empty
 
-    void Push(const NoximFlit & flit);	// Push a flit. Calls Drop method if buffer is full
+    void Push(const NoximFlitHandle flit);	// Push a flit. Calls Drop method if buffer is full
 
-    NoximFlit Pop();		// Pop a flit
+    void Pop();			// Remove the first flit
 
-    NoximFlit Front() const;	// Return a copy of the first flit in the buffer
+    NoximFlitHandle Front() const {	// The first flit in the buffer
+	if (count == 0)
+	    Empty();
+	return slots[head & mask];
+    }
 
-    unsigned int Size() const;
+    unsigned int Size() const {
+	return count;
+    }
+
+    void SampleOccupancy(const int cycles = 1);	// Account the current occupancy (once per cycle)
+
+    void ResetStats();		// Forget the sampled occupancies
 
     void ShowStats(std::ostream & out);
 
     void Disable();
 
+    void checkpoint(NoximCheckpoint & cp);	// Save the flits and the stats, or restore them
+
   private:
 
     bool true_buffer;
 
     unsigned int max_buffer_size;
 
-    queue < NoximFlit > buffer;
+    vector < NoximFlitHandle > slots;	// Circular array, size is a power of two
+    unsigned int mask;		// slots.size() - 1
+    unsigned int head;		// Position of the first flit (taken & mask)
+    unsigned int count;		// Flits in the buffer
+
+    unsigned int max_occupancy;
+    unsigned long long occupancy_sum;	// Sum of the sampled occupancies
+    unsigned long samples;
 
-    int    max_occupancy;
-    double hold_time, last_event, hold_time_sum;
-    double mean_occupancy;
-    int    previous_occupancy;
-    
-    void SaveOccupancyAndTime();
-    void UpdateMeanOccupancy();
+    void Grow();
 };
 
 #endif
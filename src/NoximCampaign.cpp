@@ -0,0 +1,475 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the fault campaign
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <fstream>
+#include <algorithm>
+#include <map>
+#include "NoximCampaign.h"
+
+NoximCampaign::NoximCampaign(NoximNoC * _noc, NoximNativeEngine * _engine)
+{
+    noc = _noc;
+    engine = _engine;
+    runs = 0;
+
+    shown_runs = 0;
+    created_packets = 0;
+    delivered_packets = 0;
+    no_path_packets = 0;
+    lossy_runs = 0;
+    delay_sum = 0.0;
+    delay_packets = 0;
+    max_delay = -1.0;
+
+    // Streams below 2 * tiles belong to the routers and the PEs
+    rng.seed(NoximGlobalParams::rnd_generator_seed,
+	     2 * NoximGlobalParams::mesh_dim_x * NoximGlobalParams::mesh_dim_y);
+}
+
+bool NoximCampaign::loadList(const char *fname)
+{
+    ifstream fin(fname, ios::in);
+    if (!fin) {
+	cerr << "Error: cannot open the fault set file " << fname << endl;
+	return false;
+    }
+
+    int tiles = NoximGlobalParams::mesh_dim_x * NoximGlobalParams::mesh_dim_y;
+    char line[512];
+
+    for (int n = 1; fin.getline(line, sizeof(line)); n++) {
+	if (line[0] == '%')
+	    continue;
+
+	// Router ids separated by blanks or commas, - for no fault
+	vector < int >faults;
+	bool ok = true, empty = true;
+	char *token = strtok(line, " \t,\r");
+
+	for (; token != NULL; token = strtok(NULL, " \t,\r")) {
+	    empty = false;
+	    if (!strcmp(token, "-"))
+		continue;
+
+	    char *end;
+	    long id = strtol(token, &end, 10);
+
+	    if (*end != '\0' || id < 0 || id >= tiles) {
+		ok = false;
+		break;
+	    }
+	    faults.push_back(id);
+	}
+
+	if (!ok) {
+	    cerr << "Error: " << fname << ":" << n <<
+		": invalid router id '" << token << "'" << endl;
+	    return false;
+	}
+
+	if (!empty) {
+	    sort(faults.begin(), faults.end());
+	    faults.erase(unique(faults.begin(), faults.end()), faults.end());
+	    list.push_back(faults);
+	}
+    }
+
+    return true;
+}
+
+bool NoximCampaign::nextFaultSet(vector < int >&faults)
+{
+    int tiles = NoximGlobalParams::mesh_dim_x * NoximGlobalParams::mesh_dim_y;
+    int k = NoximGlobalParams::campaign_faults;
+
+    switch (NoximGlobalParams::campaign) {
+    case CAMPAIGN_LIST:
+	if (runs >= list.size())
+	    return false;
+	faults = list[runs];
+	break;
+
+    case CAMPAIGN_RANDOM:{
+	    if (runs >= (unsigned int) NoximGlobalParams::campaign_runs)
+		return false;
+
+	    // First k entries of a partial shuffle of the ids
+	    vector < int >ids(tiles);
+	    for (int i = 0; i < tiles; i++)
+		ids[i] = i;
+	    for (int i = 0; i < k; i++)
+		swap(ids[i], ids[i + rng.next() % (tiles - i)]);
+
+	    faults.assign(ids.begin(), ids.begin() + k);
+	    sort(faults.begin(), faults.end());
+	    break;
+	}
+
+    case CAMPAIGN_ALL:{
+	    if (runs == 0) {
+		combination.resize(k);
+		for (int i = 0; i < k; i++)
+		    combination[i] = i;
+	    } else {
+		// Rightmost id that can still be increased
+		int i = k - 1;
+		while (i >= 0 && combination[i] == tiles - k + i)
+		    i--;
+		if (i < 0)
+		    return false;
+
+		combination[i]++;
+		for (int l = i + 1; l < k; l++)
+		    combination[l] = combination[l - 1] + 1;
+	    }
+	    faults = combination;
+	    break;
+	}
+
+    default:
+	return false;
+    }
+
+    runs++;
+    return true;
+}
+
+void NoximCampaign::simulate(const vector < int >&faults,
+			     NoximCampaignResult & result)
+{
+    FaultRouter = faults;
+    noc->restart();
+
+    engine->reset(DEFAULT_RESET_TIME);
+    engine->run(NoximGlobalParams::simulation_time);
+
+    collect(result);
+}
+
+void NoximCampaign::simulateBranch(const vector < int >&faults,
+				   NoximCampaignResult & result)
+{
+    for (unsigned int i = 0; i < faults.size(); i++)
+	noc->setFault(faults[i], true);
+
+    engine->run(NoximGlobalParams::simulation_time -
+		NoximGlobalParams::stats_warm_up_time);
+
+    collect(result);
+}
+
+void NoximCampaign::collect(NoximCampaignResult & result)
+{
+    NoximGlobalStats gs(noc);
+    gs.getDigest(result.digest);
+
+    result.delay_packets = 0;
+    for (int x = 0; x < NoximGlobalParams::mesh_dim_x; x++)
+	for (int y = 0; y < NoximGlobalParams::mesh_dim_y; y++)
+	    result.delay_packets += noc->t[x][y]->r->stats.getReceivedPackets();
+}
+
+void NoximCampaign::showHeader(ostream & out) const
+{
+    out << "% faults created delivered no_path avg_delay max_delay"
+	<< " throughput power cycles" << endl;
+}
+
+void NoximCampaign::showRow(ostream & out, const vector < int >&faults,
+			    const NoximCampaignResult & result)
+{
+    const NoximStatsDigest & digest = result.digest;
+
+    if (faults.empty())
+	out << "-";
+    for (unsigned int i = 0; i < faults.size(); i++)
+	out << (i > 0 ? "," : "") << faults[i];
+
+    // Delay and throughput of the packets received after the warm-up,
+    // -1 like the maximum delay if there are none
+    bool measured = result.delay_packets > 0;
+
+    out << " " << digest.created_packets
+	<< " " << digest.delivered_packets
+	<< " " << digest.no_path_packets
+	<< " " << (measured ? digest.average_delay : -1.0)
+	<< " " << digest.max_delay
+	<< " " << (measured ? digest.throughput : -1.0)
+	<< " " << digest.power
+	<< " " << digest.cycles << endl;
+
+    shown_runs++;
+    created_packets += digest.created_packets;
+    delivered_packets += digest.delivered_packets;
+    no_path_packets += digest.no_path_packets;
+    if (digest.no_path_packets > 0)
+	lossy_runs++;
+    if (measured) {
+	delay_sum += result.delay_packets * digest.average_delay;
+	delay_packets += result.delay_packets;
+    }
+    max_delay = max(max_delay, digest.max_delay);
+}
+
+void NoximCampaign::showSummary(ostream & out) const
+{
+    out << "% runs: " << shown_runs << endl;
+    out << "% runs with packets without a path: " << lossy_runs << endl;
+    out << "% created packets: " << created_packets << endl;
+    out << "% delivered packets: " << delivered_packets << endl;
+    out << "% packets without a path: " << no_path_packets << endl;
+    // -1 when there is nothing to measure, like the maximum delay
+    out << "% reachability (delivered/created packets): " <<
+	(created_packets > 0 ? (double) delivered_packets / created_packets :
+	 -1.0) << endl;
+    out << "% average delay (cycles): " <<
+	(delay_packets > 0 ? delay_sum / delay_packets : -1.0) << endl;
+    out << "% max delay (cycles): " << max_delay << endl;
+}
+
+void NoximCampaign::work(unsigned int *next, const int fd)
+{
+    vector < int >faults;
+    NoximCampaignResult result;
+
+    cout.rdbuf(NULL);
+
+    for (;;) {
+	unsigned int index = __atomic_fetch_add(next, 1, __ATOMIC_RELAXED);
+
+	// The sets before the one taken are simulated by other workers
+	bool found;
+	while ((found = nextFaultSet(faults)) && runs - 1 < index);
+	if (!found)
+	    return;
+
+	simulate(faults, result);
+	result.index = index;
+
+	// Smaller than PIPE_BUF: written at once, even with many writers
+	if (write(fd, &result, sizeof(result)) != (ssize_t) sizeof(result))
+	    return;
+    }
+}
+
+bool NoximCampaign::runParallel(ostream & out, const int jobs)
+{
+    // Index of the next set to simulate, shared by the workers
+    unsigned int *next = (unsigned int *) mmap(NULL, sizeof(unsigned int),
+					       PROT_READ | PROT_WRITE,
+					       MAP_SHARED | MAP_ANONYMOUS,
+					       -1, 0);
+    int fds[2];
+
+    if (next == MAP_FAILED || pipe(fds) != 0) {
+	cerr << "Error: cannot start the campaign workers" << endl;
+	return false;
+    }
+    *next = 0;
+
+    out.flush();
+    cout.flush();
+
+    vector < pid_t > workers;
+    for (int w = 0; w < jobs; w++) {
+	pid_t pid = fork();
+
+	if (pid < 0) {
+	    cerr << "Error: cannot start the campaign workers" << endl;
+	    break;
+	}
+	if (pid == 0) {
+	    close(fds[0]);
+	    work(next, fds[1]);
+	    close(fds[1]);
+	    _exit(0);
+	}
+	workers.push_back(pid);
+    }
+    close(fds[1]);
+
+    // Rows in the order of the sets, whichever worker completes first
+    map < unsigned int, NoximCampaignResult > completed;
+    NoximCampaignResult result;
+    vector < int >faults;
+    size_t got = 0;
+    ssize_t r;
+
+    while ((r = read(fds[0], (char *) &result + got,
+		     sizeof(result) - got)) > 0) {
+	got += r;
+	if (got < sizeof(result))
+	    continue;
+	got = 0;
+
+	completed[result.index] = result;
+	while (completed.count(runs) > 0) {
+	    nextFaultSet(faults);
+	    showRow(out, faults, completed[runs - 1]);
+	    completed.erase(runs - 1);
+	}
+    }
+    close(fds[0]);
+
+    bool ok = !workers.empty();
+    for (unsigned int w = 0; w < workers.size(); w++) {
+	int status;
+	if (waitpid(workers[w], &status, 0) < 0 || !WIFEXITED(status)
+	    || WEXITSTATUS(status) != 0)
+	    ok = false;
+    }
+    munmap(next, sizeof(unsigned int));
+
+    // Every set must have been shown
+    if (!ok || nextFaultSet(faults)) {
+	cerr << "Error: a campaign worker did not complete" << endl;
+	return false;
+    }
+
+    return true;
+}
+
+bool NoximCampaign::runBranches(ostream & out, const int jobs)
+{
+    // Warm-up shared by every branch
+    cout.flush();
+    streambuf *console = cout.rdbuf(NULL);
+    FaultRouter.clear();
+    noc->restart();
+    engine->reset(DEFAULT_RESET_TIME);
+    engine->run(NoximGlobalParams::stats_warm_up_time);
+    cout.rdbuf(console);
+
+    // The fault sets would be evaluated on an empty network
+    if (native_stop) {
+	cerr << "Error: the simulation stopped during the warm-up shared by the branches" << endl;
+	return false;
+    }
+
+    out.flush();
+    cout.flush();
+
+    // Each branch hands its result over its own pipe, read once it has
+    // exited: the result is smaller than the pipe buffer
+    map < pid_t, pair < unsigned int, int > > running;	// Set index, read end
+    map < unsigned int, vector < int > > sets;	// Sets not shown yet
+    map < unsigned int, NoximCampaignResult > completed;
+    vector < int >faults;
+    unsigned int forked = 0, shown = 0;
+    bool ok = true;
+
+    for (;;) {
+	while (ok && (int) running.size() < jobs && nextFaultSet(faults)) {
+	    int fds[2];
+	    pid_t pid = -1;
+
+	    if (pipe(fds) != 0 || (pid = fork()) < 0) {
+		cerr << "Error: cannot start the campaign branches" << endl;
+		ok = false;
+		break;
+	    }
+	    if (pid == 0) {
+		NoximCampaignResult result;
+
+		close(fds[0]);
+		cout.rdbuf(NULL);
+		simulateBranch(faults, result);
+		result.index = forked;
+
+		bool sent = (write(fds[1], &result, sizeof(result)) ==
+			     (ssize_t) sizeof(result));
+		_exit(sent ? 0 : 1);
+	    }
+	    close(fds[1]);
+	    running[pid] = make_pair(forked, fds[0]);
+	    sets[forked++] = faults;
+	}
+
+	if (running.empty())
+	    break;
+
+	int status;
+	pid_t pid = waitpid(-1, &status, 0);
+	if (pid < 0) {
+	    ok = false;
+	    break;
+	}
+
+	map < pid_t, pair < unsigned int, int > >::iterator it =
+	    running.find(pid);
+	if (it == running.end())
+	    continue;
+
+	NoximCampaignResult result;
+	if (WIFEXITED(status) && WEXITSTATUS(status) == 0 &&
+	    read(it->second.second, &result, sizeof(result)) ==
+	    (ssize_t) sizeof(result))
+	    completed[result.index] = result;
+	else
+	    ok = false;
+	close(it->second.second);
+	running.erase(it);
+
+	// Rows in the order of the sets, whichever branch completes first
+	while (completed.count(shown) > 0) {
+	    showRow(out, sets[shown], completed[shown]);
+	    completed.erase(shown);
+	    sets.erase(shown);
+	    shown++;
+	}
+    }
+
+    if (!ok || shown < forked) {
+	cerr << "Error: a campaign branch did not complete" << endl;
+	return false;
+    }
+
+    return true;
+}
+
+bool NoximCampaign::run(ostream & out)
+{
+    if (NoximGlobalParams::campaign == CAMPAIGN_LIST &&
+	!loadList(NoximGlobalParams::campaign_filename))
+	return false;
+
+    showHeader(out);
+
+    if (NoximGlobalParams::campaign_branch) {
+	if (!runBranches(out, NoximGlobalParams::jobs))
+	    return false;
+    } else if (NoximGlobalParams::jobs > 1) {
+	if (!runParallel(out, NoximGlobalParams::jobs))
+	    return false;
+    } else {
+	vector < int >faults;
+
+	while (nextFaultSet(faults)) {
+	    NoximCampaignResult result;
+
+	    // The messages of the simulation would bury the rows
+	    cout.flush();
+	    streambuf *console = cout.rdbuf(NULL);
+	    simulate(faults, result);
+	    cout.rdbuf(console);
+
+	    showRow(out, faults, result);
+	}
+    }
+
+    showSummary(out);
+
+    return true;
+}
@@ -0,0 +1,110 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the fault campaign
+ */
+
+#ifndef __NOXIMCAMPAIGN_H__
+#define __NOXIMCAMPAIGN_H__
+
+#include <iostream>
+#include <vector>
+#include "NoximMain.h"
+#include "NoximNoC.h"
+#include "NoximNativeEngine.h"
+#include "NoximGlobalStats.h"
+using namespace std;
+
+// NoximCampaignResult -- figures of the run of one fault set, as sent
+// by a worker process
+struct NoximCampaignResult {
+    unsigned int index;		// Position of the set in the campaign
+    unsigned int delay_packets;	// Packets behind the average delay
+    NoximStatsDigest digest;
+};
+
+// NoximCampaign -- simulates the same elaborated NoC once per fault set,
+// bringing it back to its state after elaboration between the runs. Each
+// run gives the figures of a separate simulation with those faulty
+// routers, without paying elaboration and power data loading again.
+//
+// The fault sets are read from a file (one set of router ids per line),
+// drawn at random or enumerated (every set of K routers, in
+// lexicographic order). One row per set is printed, then a summary of
+// the whole campaign.
+//
+// With more than one job the sets are simulated by worker processes
+// forked after elaboration, each one with its own copy of the NoC and of
+// the global state. A worker takes the next set not yet taken as soon as
+// it is free, so long and short runs balance out; the rows are printed in
+// the order of the sets anyway.
+//
+// When branching, the warm-up is simulated once without faulty routers;
+// then a process forked from the warmed up NoC adds the faulty routers of
+// each set and simulates the rest of the run. The processes share the
+// pages of the NoC until they write them, and up to 'jobs' of them run
+// at the same time.
+class NoximCampaign {
+
+  public:
+
+    NoximCampaign(NoximNoC * _noc, NoximNativeEngine * _engine);
+
+    // Runs every fault set of the campaign. Returns false if the fault
+    // sets cannot be read
+    bool run(ostream & out);
+
+  private:
+
+    NoximNoC *noc;
+    NoximNativeEngine *engine;
+
+    vector < vector < int > > list;	// CAMPAIGN_LIST: the sets of the file
+    unsigned int runs;		// Fault sets produced so far
+    NoximRandom rng;		// CAMPAIGN_RANDOM: draws of the sets
+    vector < int > combination;	// CAMPAIGN_ALL: the last set produced
+
+    // Summary of the runs shown so far
+    unsigned int shown_runs;
+    unsigned long long created_packets;
+    unsigned long long delivered_packets;
+    unsigned long long no_path_packets;
+    unsigned int lossy_runs;	// Runs with packets without a path
+    double delay_sum;		// Average delays weighted by their packets
+    unsigned long long delay_packets;
+    double max_delay;
+
+    bool loadList(const char *fname);
+
+    // Next fault set, in increasing order of router id. Returns false
+    // when the sets are over
+    bool nextFaultSet(vector < int > &faults);
+
+    // Simulates from time zero with the given faulty routers
+    void simulate(const vector < int > &faults, NoximCampaignResult & result);
+
+    // Adds the faulty routers to the NoC at the end of the warm-up and
+    // simulates the rest of the run
+    void simulateBranch(const vector < int > &faults,
+			NoximCampaignResult & result);
+
+    // Figures of the run just simulated
+    void collect(NoximCampaignResult & result);
+
+    // Worker process: simulates the sets it takes from 'next' and writes
+    // the results on fd
+    void work(unsigned int *next, const int fd);
+    bool runParallel(ostream & out, const int jobs);
+    bool runBranches(ostream & out, const int jobs);
+
+    void showHeader(ostream & out) const;
+    void showRow(ostream & out, const vector < int > &faults,
+		 const NoximCampaignResult & result);
+    void showSummary(ostream & out) const;
+};
+
+#endif
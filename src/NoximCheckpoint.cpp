@@ -0,0 +1,136 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the simulation checkpoint
+ */
+
+#include <cstring>
+#include "NoximMain.h"
+#include "NoximCheckpoint.h"
+
+NoximCheckpoint::NoximCheckpoint()
+{
+    file = NULL;
+    restoring = false;
+    ok = true;
+    remaining = 0;
+    memset(&header, 0, sizeof(header));
+}
+
+NoximCheckpoint::~NoximCheckpoint()
+{
+    close();
+}
+
+bool NoximCheckpoint::create(const char *fname, const int simulated_cycles)
+{
+    close();
+
+    file = fopen(fname, "wb");
+    if (file == NULL)
+	return false;
+
+    restoring = false;
+    ok = true;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.cycle = getCurrentCycle();
+    header.simulated_cycles = simulated_cycles;
+    header.mesh_dim_x = NoximGlobalParams::mesh_dim_x;
+    header.mesh_dim_y = NoximGlobalParams::mesh_dim_y;
+    header.buffer_depth = NoximGlobalParams::buffer_depth;
+    header.min_packet_size = NoximGlobalParams::min_packet_size;
+    header.max_packet_size = NoximGlobalParams::max_packet_size;
+    header.routing_algorithm = NoximGlobalParams::routing_algorithm;
+    header.selection_strategy = NoximGlobalParams::selection_strategy;
+    header.packet_injection_rate = NoximGlobalParams::packet_injection_rate;
+    header.probability_of_retransmission =
+	NoximGlobalParams::probability_of_retransmission;
+
+    transfer(header);
+
+    return ok;
+}
+
+bool NoximCheckpoint::open(const char *fname)
+{
+    close();
+
+    file = fopen(fname, "rb");
+    if (file == NULL) {
+	cerr << "Error: cannot open the checkpoint " << fname << endl;
+	return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    remaining = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    restoring = true;
+    ok = true;
+    transfer(header);
+
+    if (!ok || strncmp(header.magic, CHECKPOINT_MAGIC,
+		       sizeof(header.magic)) != 0) {
+	cerr << "Error: " << fname << " is not a noxim checkpoint" << endl;
+	return false;
+    }
+
+    if (header.version != CHECKPOINT_VERSION) {
+	cerr << "Error: " << fname << ": unsupported checkpoint version " <<
+	    header.version << endl;
+	return false;
+    }
+
+    // The buffers, the flit blocks and the routing state depend on these
+    if (header.mesh_dim_x != NoximGlobalParams::mesh_dim_x ||
+	header.mesh_dim_y != NoximGlobalParams::mesh_dim_y ||
+	header.buffer_depth != NoximGlobalParams::buffer_depth ||
+	header.min_packet_size != NoximGlobalParams::min_packet_size ||
+	header.max_packet_size != NoximGlobalParams::max_packet_size ||
+	header.routing_algorithm != NoximGlobalParams::routing_algorithm ||
+	header.selection_strategy != NoximGlobalParams::selection_strategy) {
+	cerr << "Error: " << fname <<
+	    " was saved with a different mesh, buffer depth, packet size, routing or selection"
+	    << endl;
+	return false;
+    }
+
+    return true;
+}
+
+bool NoximCheckpoint::close()
+{
+    if (file == NULL)
+	return ok;
+
+    // Bytes left over mean the state was saved by a different layout
+    if (restoring ? remaining != 0 : fflush(file) != 0)
+	ok = false;
+
+    fclose(file);
+    file = NULL;
+
+    return ok;
+}
+
+void NoximCheckpoint::bytes(void *data, const size_t size)
+{
+    if (!ok || size == 0)
+	return;
+
+    if (restoring) {
+	if (size > remaining || fread(data, size, 1, file) != 1) {
+	    ok = false;
+	    return;
+	}
+	remaining -= size;
+    } else if (fwrite(data, size, 1, file) != 1)
+	ok = false;
+}
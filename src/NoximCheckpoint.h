@@ -0,0 +1,120 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the simulation checkpoint
+ */
+
+#ifndef __NOXIMCHECKPOINT_H__
+#define __NOXIMCHECKPOINT_H__
+
+#include <cstdio>
+#include <vector>
+using namespace std;
+
+#define CHECKPOINT_MAGIC       "NOXIMCKP"
+#define CHECKPOINT_VERSION     3
+
+// NoximCheckpointHeader -- start of the checkpoint file: the cycle it
+// was taken at and the configuration the state depends on
+struct NoximCheckpointHeader {
+    char magic[8];
+    unsigned int version;
+    double cycle;		// Time of the native engine
+    int simulated_cycles;	// Cycles run after the reset
+    int mesh_dim_x;
+    int mesh_dim_y;
+    int buffer_depth;
+    int min_packet_size;
+    int max_packet_size;
+    int routing_algorithm;
+    int selection_strategy;
+    float packet_injection_rate;
+    float probability_of_retransmission;
+};
+
+// NoximCheckpoint -- binary file holding the whole state of a simulation
+// run by the native engine. Saving and restoring walk the same code:
+// each block hands its state to transfer(), which writes it to the file
+// or overwrites it with the values read back, so the two directions
+// cannot get out of step.
+//
+// Errors while transferring are remembered and reported by close().
+class NoximCheckpoint {
+
+  public:
+
+    NoximCheckpoint();
+    ~NoximCheckpoint();
+
+    // Create the file and write the header for the current cycle.
+    // Returns false if the file cannot be created
+    bool create(const char *fname, const int simulated_cycles);
+
+    // Open the file and read its header. Errors are reported on cerr,
+    // including a configuration the state does not fit; returns true if
+    // ok, false otherwise
+    bool open(const char *fname);
+
+    // Close the file. Returns false if any transfer failed or, when
+    // restoring, if the state did not take up the whole file
+    bool close();
+
+    inline bool isRestoring() const {
+	return restoring;
+    }
+
+    // No transfer failed so far
+    inline bool good() const {
+	return ok;
+    }
+
+    const NoximCheckpointHeader & getHeader() const {
+	return header;
+    }
+
+    // Plain data (no pointers) in either direction
+    template < class T > void transfer(T & value) {
+	bytes(&value, sizeof(T));
+    }
+
+    template < class T > void transfer(T * values, const size_t n) {
+	bytes(values, n * sizeof(T));
+    }
+
+    // Vector of plain data, preceded by its size
+    template < class T > void transfer(vector < T > &values) {
+	unsigned long long n = values.size();
+
+	transfer(n);
+	if (restoring) {
+	    // A corrupted size must not exhaust the memory
+	    if (!ok || n > remaining / (sizeof(T) > 0 ? sizeof(T) : 1)) {
+		ok = false;
+		values.clear();
+		return;
+	    }
+	    values.resize(n);
+	}
+	if (n > 0)
+	    transfer(&values[0], n);
+    }
+
+  private:
+
+    FILE *file;
+    bool restoring;
+    bool ok;			// No transfer failed so far
+    unsigned long long remaining;	// Bytes left to read
+    NoximCheckpointHeader header;
+
+    void bytes(void *data, const size_t size);
+
+    NoximCheckpoint(const NoximCheckpoint &);
+    NoximCheckpoint & operator=(const NoximCheckpoint &);
+};
+
+#endif
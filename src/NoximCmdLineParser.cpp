@@ -110,7 +110,70 @@ void showHelp(char selfname[])
 	<< endl;
     cout <<
 	"\t-sim N\t\tRun for the specified simulation time [cycles] (default "
-	<< DEFAULT_SIMULATION_TIME << ")" << endl << endl;
+	<< DEFAULT_SIMULATION_TIME << ")" << endl;
+    cout <<
+	"\t-engine TYPE\tSet the simulation engine to TYPE where TYPE is one of the following (default "
+	<< DEFAULT_ENGINE << "):" << endl;
+    cout << "\t\tsystemc\t\tSystemC kernel with signal level wiring" << endl;
+    cout << "\t\tnative\t\tNative cycle-driven loop, no SystemC scheduler" << endl;
+    cout << "\t\tverify\t\tRun both and check that their statistics match" << endl;
+    cout <<
+	"\t-threads N\tSplit the mesh among N threads, native engine only (default "
+	<< DEFAULT_THREADS << ")" << endl;
+    cout <<
+	"\t-no_fast_forward\tStep every cycle even when the network is empty, native engine only"
+	<< endl;
+    cout <<
+	"\t-routing_check\tCheck the compiled fault tolerant routing table against the routing function"
+	<< endl;
+    cout <<
+	"\t-faults FILENAME\tFail and recover routers and links at the cycles listed in FILENAME, instead of the built-in faulty routers"
+	<< endl;
+    cout <<
+	"\t-reachability\tWalk the fault tolerant routing between every pair of working routers instead of simulating"
+	<< endl;
+    cout <<
+	"\t-campaign TYPE\tSimulate the NoC once per fault set, native engine only, where TYPE is one of the following:"
+	<< endl;
+    cout << "\t\tlist FILENAME\tThe sets of router ids in FILENAME, one per line" << endl;
+    cout << "\t\trandom N K\tN random sets of K routers" << endl;
+    cout << "\t\tall K\t\tEvery set of K routers" << endl;
+    cout <<
+	"\t-jobs N\tSimulate the fault sets of a campaign in N processes (default "
+	<< DEFAULT_JOBS << ")" << endl;
+    cout <<
+	"\t-branch\tSimulate the warm-up of a campaign once, then fork a process from it for each fault set"
+	<< endl;
+    cout <<
+	"\t-saturation MIN MAX\tSearch the packet injection rate between MIN and MAX at which the NoC saturates, native engine only"
+	<< endl;
+    cout <<
+	"\t-saturation_factor F\tThe NoC saturates when the average delay exceeds F times the zero-load delay (default "
+	<< DEFAULT_SATURATION_FACTOR << ")" << endl;
+    cout <<
+	"\t-steady N TOLERANCE\tEnd the warm-up and the simulation once the delay and throughput means over batches of N cycles are known within TOLERANCE (e.g. 0.05 for 5%)"
+	<< endl;
+    cout <<
+	"\t-log LEVEL FILENAME\tWrite the events up to LEVEL to the binary log FILENAME, where LEVEL is one of the following:"
+	<< endl;
+    cout << "\t\t1\t\tFinal state of every packet" << endl;
+    cout << "\t\t2\t\tCreation and sending of every packet too" << endl;
+    cout << "\t\t3\t\tRouting decisions without a path too" << endl;
+    cout <<
+	"\t-packet_trace N FILENAME\tKeep the last N events of the life of the packets in the memory mapped file FILENAME"
+	<< endl;
+    cout <<
+	"\t-delay_histogram FILENAME\tWrite the histograms of the packet delays, global and per destination, to FILENAME"
+	<< endl;
+    cout <<
+	"\t-snapshot N FILENAME\tWrite the metrics of the NoC every N cycles to the CSV file FILENAME"
+	<< endl;
+    cout <<
+	"\t-save_checkpoint FILENAME\tSave the state of the simulation at its end to FILENAME, native engine only"
+	<< endl;
+    cout <<
+	"\t-restore_checkpoint FILENAME\tContinue the simulation saved in FILENAME for the cycles given by -sim, native engine only"
+	<< endl << endl;
     cout <<
 	"If you find this program useful please don't forget to mention in your paper Maurizio Palesi <maurizio.palesi@unikore.it>"
 	<< endl;
@@ -150,6 +213,41 @@ void showConfig()
 	stats_warm_up_time << endl;
     cout << "- rnd_generator_seed = " << NoximGlobalParams::
 	rnd_generator_seed << endl;
+    cout << "- engine = " << NoximGlobalParams::engine << endl;
+    cout << "- threads = " << NoximGlobalParams::threads << endl;
+    cout << "- fast_forward = " << NoximGlobalParams::fast_forward << endl;
+    cout << "- routing_check = " << NoximGlobalParams::routing_check << endl;
+    cout << "- faults_filename = " << NoximGlobalParams::faults_filename << endl;
+    cout << "- reachability = " << NoximGlobalParams::reachability << endl;
+    cout << "- campaign = " << NoximGlobalParams::campaign << endl;
+    cout << "- saturation = " << NoximGlobalParams::saturation << endl;
+    cout << "- saturation_min_pir = " << NoximGlobalParams::
+	saturation_min_pir << endl;
+    cout << "- saturation_max_pir = " << NoximGlobalParams::
+	saturation_max_pir << endl;
+    cout << "- saturation_factor = " << NoximGlobalParams::
+	saturation_factor << endl;
+    cout << "- steady_batch = " << NoximGlobalParams::steady_batch << endl;
+    cout << "- steady_tolerance = " << NoximGlobalParams::
+	steady_tolerance << endl;
+    cout << "- jobs = " << NoximGlobalParams::jobs << endl;
+    cout << "- campaign_branch = " << NoximGlobalParams::campaign_branch << endl;
+    cout << "- log_level = " << NoximGlobalParams::log_level << endl;
+    cout << "- log_filename = " << NoximGlobalParams::log_filename << endl;
+    cout << "- packet_trace_records = " << NoximGlobalParams::
+	packet_trace_records << endl;
+    cout << "- packet_trace_filename = " << NoximGlobalParams::
+	packet_trace_filename << endl;
+    cout << "- delay_histogram_filename = " << NoximGlobalParams::
+	delay_histogram_filename << endl;
+    cout << "- snapshot_interval = " << NoximGlobalParams::
+	snapshot_interval << endl;
+    cout << "- snapshot_filename = " << NoximGlobalParams::
+	snapshot_filename << endl;
+    cout << "- save_checkpoint_filename = " << NoximGlobalParams::
+	save_checkpoint_filename << endl;
+    cout << "- restore_checkpoint_filename = " << NoximGlobalParams::
+	restore_checkpoint_filename << endl;
 }
 
 void checkInputParameters()
@@ -164,6 +262,14 @@ void checkInputParameters()
 	exit(1);
     }
 
+    // Tile ids and flit sequence numbers are 16 bit wide in NoximFlit
+    if (NoximGlobalParams::mesh_dim_x * NoximGlobalParams::mesh_dim_y >
+	USHRT_MAX + 1) {
+	cerr << "Error: the mesh must have at most " << USHRT_MAX + 1
+	    << " tiles" << endl;
+	exit(1);
+    }
+
     if (NoximGlobalParams::buffer_depth < 1) {
 	cerr << "Error: buffer must be >= 1" << endl;
 	exit(1);
@@ -175,6 +281,11 @@ void checkInputParameters()
 	exit(1);
     }
 
+    if (NoximGlobalParams::max_packet_size > USHRT_MAX + 1) {
+	cerr << "Error: packet size must be <= " << USHRT_MAX + 1 << endl;
+	exit(1);
+    }
+
     if (NoximGlobalParams::min_packet_size >
 	NoximGlobalParams::max_packet_size) {
 	cerr << "Error: min packet size must be less than max packet size"
@@ -232,8 +343,10 @@ void checkInputParameters()
 	exit(1);
     }
 
+    // A continued simulation keeps the warm-up of its checkpoint
     if (NoximGlobalParams::stats_warm_up_time >
-	NoximGlobalParams::simulation_time) {
+	NoximGlobalParams::simulation_time &&
+	NoximGlobalParams::restore_checkpoint_filename[0] == '\0') {
 	cerr << "Error: warmup time must be less than simulation time" <<
 	    endl;
 	exit(1);
@@ -248,6 +361,215 @@ void checkInputParameters()
 	cerr << "Error: qos must be in the range [0,1]" << endl;
 	exit(1);
     }
+
+    if (NoximGlobalParams::engine == INVALID_ENGINE) {
+	cerr << "Error: invalid engine" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::trace_mode &&
+	NoximGlobalParams::engine != ENGINE_SYSTEMC) {
+	cerr << "Error: signal tracing requires the systemc engine" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::threads < 1) {
+	cerr << "Error: the number of threads must be at least 1" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::threads > 1 &&
+	NoximGlobalParams::engine == ENGINE_SYSTEMC &&
+	!NoximGlobalParams::reachability) {
+	cerr << "Error: multiple threads require the native engine" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::routing_check &&
+	NoximGlobalParams::routing_algorithm !=
+	ROUTING_NEGATIVE_FIRST_FAULT_TOLERANCE) {
+	cerr << "Error: the routing check applies to the default (fault tolerant) routing only" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::reachability) {
+	if (NoximGlobalParams::routing_algorithm !=
+	    ROUTING_NEGATIVE_FIRST_FAULT_TOLERANCE) {
+	    cerr << "Error: the reachability analysis applies to the default (fault tolerant) routing only" << endl;
+	    exit(1);
+	}
+
+	if (NoximGlobalParams::campaign != CAMPAIGN_OFF) {
+	    cerr << "Error: the reachability analysis cannot be used in a fault campaign" << endl;
+	    exit(1);
+	}
+    }
+
+    if (NoximGlobalParams::campaign == INVALID_CAMPAIGN) {
+	cerr << "Error: invalid fault campaign" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::campaign != CAMPAIGN_OFF) {
+	int tiles = NoximGlobalParams::mesh_dim_x * NoximGlobalParams::mesh_dim_y;
+
+	if (NoximGlobalParams::engine != ENGINE_NATIVE) {
+	    cerr << "Error: fault campaigns require the native engine" << endl;
+	    exit(1);
+	}
+
+	if (NoximGlobalParams::faults_filename[0] != '\0') {
+	    cerr << "Error: fault events cannot be used in a fault campaign" << endl;
+	    exit(1);
+	}
+
+	if (NoximGlobalParams::campaign == CAMPAIGN_RANDOM &&
+	    NoximGlobalParams::campaign_runs < 1) {
+	    cerr << "Error: a random fault campaign needs at least one run" << endl;
+	    exit(1);
+	}
+
+	if (NoximGlobalParams::campaign_faults < 0 ||
+	    NoximGlobalParams::campaign_faults > tiles) {
+	    cerr << "Error: the faulty routers of a campaign must be between 0 and "
+		<< tiles << endl;
+	    exit(1);
+	}
+    }
+
+    if (NoximGlobalParams::jobs < 1) {
+	cerr << "Error: the number of jobs must be at least 1" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::jobs > 1 &&
+	NoximGlobalParams::campaign == CAMPAIGN_OFF) {
+	cerr << "Error: multiple jobs require a fault campaign" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::campaign_branch &&
+	NoximGlobalParams::campaign == CAMPAIGN_OFF) {
+	cerr << "Error: branching requires a fault campaign" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::saturation) {
+	if (NoximGlobalParams::engine != ENGINE_NATIVE) {
+	    cerr << "Error: the saturation search requires the native engine" << endl;
+	    exit(1);
+	}
+
+	if (NoximGlobalParams::campaign != CAMPAIGN_OFF ||
+	    NoximGlobalParams::reachability) {
+	    cerr << "Error: the saturation search cannot be combined with a fault campaign or the reachability analysis" << endl;
+	    exit(1);
+	}
+
+	if (NoximGlobalParams::traffic_distribution == TRAFFIC_TABLE_BASED) {
+	    cerr << "Error: the saturation search needs a uniform packet injection rate, not a traffic table" << endl;
+	    exit(1);
+	}
+
+	if (NoximGlobalParams::saturation_min_pir <= 0.0 ||
+	    NoximGlobalParams::saturation_max_pir > 1.0 ||
+	    NoximGlobalParams::saturation_min_pir >=
+	    NoximGlobalParams::saturation_max_pir) {
+	    cerr << "Error: the injection rates of the saturation search must satisfy 0 < MIN < MAX <= 1" << endl;
+	    exit(1);
+	}
+
+	if (NoximGlobalParams::saturation_factor <= 1.0) {
+	    cerr << "Error: the saturation factor must be greater than 1" << endl;
+	    exit(1);
+	}
+
+	if (NoximGlobalParams::log_level != LOG_OFF ||
+	    NoximGlobalParams::packet_trace_filename[0] != '\0' ||
+	    NoximGlobalParams::delay_histogram_filename[0] != '\0' ||
+	    NoximGlobalParams::snapshot_filename[0] != '\0') {
+	    cerr << "Error: the saturation search writes no log, trace, histogram or snapshot" << endl;
+	    exit(1);
+	}
+    }
+
+    if (NoximGlobalParams::steady_batch < 0) {
+	cerr << "Error: the steady state batches must be at least one cycle long" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::steady_batch > 0) {
+	if (NoximGlobalParams::steady_tolerance <= 0.0) {
+	    cerr << "Error: the steady state tolerance must be greater than 0" << endl;
+	    exit(1);
+	}
+
+	if (NoximGlobalParams::campaign != CAMPAIGN_OFF ||
+	    NoximGlobalParams::saturation) {
+	    cerr << "Error: the steady state detection applies to a single simulation" << endl;
+	    exit(1);
+	}
+    }
+
+    if (NoximGlobalParams::log_filename[0] != '\0' &&
+	(NoximGlobalParams::log_level < LOG_STATES ||
+	 NoximGlobalParams::log_level > LOG_ROUTING)) {
+	cerr << "Error: the log level must be between " << LOG_STATES <<
+	    " and " << LOG_ROUTING << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::log_level != LOG_OFF &&
+	NoximGlobalParams::campaign != CAMPAIGN_OFF) {
+	cerr << "Error: the event log cannot be used in a fault campaign" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::packet_trace_filename[0] != '\0') {
+	if (NoximGlobalParams::packet_trace_records < 1) {
+	    cerr << "Error: the packet trace needs room for at least one record" << endl;
+	    exit(1);
+	}
+
+	if (NoximGlobalParams::campaign != CAMPAIGN_OFF) {
+	    cerr << "Error: the packet trace cannot be used in a fault campaign" << endl;
+	    exit(1);
+	}
+    }
+
+    if (NoximGlobalParams::delay_histogram_filename[0] != '\0' &&
+	NoximGlobalParams::campaign != CAMPAIGN_OFF) {
+	cerr << "Error: the delay histograms cannot be written in a fault campaign" << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::snapshot_filename[0] != '\0') {
+	if (NoximGlobalParams::snapshot_interval < 1) {
+	    cerr << "Error: the snapshot interval must be at least one cycle" << endl;
+	    exit(1);
+	}
+
+	if (NoximGlobalParams::campaign != CAMPAIGN_OFF) {
+	    cerr << "Error: snapshots cannot be taken in a fault campaign" << endl;
+	    exit(1);
+	}
+    }
+
+    if (NoximGlobalParams::save_checkpoint_filename[0] != '\0' ||
+	NoximGlobalParams::restore_checkpoint_filename[0] != '\0') {
+	if (NoximGlobalParams::engine != ENGINE_NATIVE) {
+	    cerr << "Error: checkpoints require the native engine" << endl;
+	    exit(1);
+	}
+
+	if (NoximGlobalParams::campaign != CAMPAIGN_OFF ||
+	    NoximGlobalParams::saturation ||
+	    NoximGlobalParams::steady_batch > 0 ||
+	    NoximGlobalParams::reachability) {
+	    cerr << "Error: checkpoints apply to a single simulation of fixed length" << endl;
+	    exit(1);
+	}
+    }
 }
 
 //---------------------------------------------------------------------------
@@ -393,6 +715,75 @@ void parseCmdLine(int arg_num, char *arg_vet[])
 	      NoximGlobalParams::low_power_link_strategy = true;
 	    else if (!strcmp(arg_vet[i], "-qos"))
 		NoximGlobalParams::qos = atof(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-engine")) {
+		char *engine = arg_vet[++i];
+		if (!strcmp(engine, "systemc"))
+		    NoximGlobalParams::engine = ENGINE_SYSTEMC;
+		else if (!strcmp(engine, "native"))
+		    NoximGlobalParams::engine = ENGINE_NATIVE;
+		else if (!strcmp(engine, "verify"))
+		    NoximGlobalParams::engine = ENGINE_VERIFY;
+		else
+		    NoximGlobalParams::engine = INVALID_ENGINE;
+	    }
+	    else if (!strcmp(arg_vet[i], "-threads"))
+		NoximGlobalParams::threads = atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-no_fast_forward"))
+		NoximGlobalParams::fast_forward = false;
+	    else if (!strcmp(arg_vet[i], "-routing_check"))
+		NoximGlobalParams::routing_check = true;
+	    else if (!strcmp(arg_vet[i], "-faults"))
+		strcpy(NoximGlobalParams::faults_filename, arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-reachability"))
+		NoximGlobalParams::reachability = true;
+	    else if (!strcmp(arg_vet[i], "-saturation")) {
+		NoximGlobalParams::saturation = true;
+		NoximGlobalParams::saturation_min_pir = atof(arg_vet[++i]);
+		NoximGlobalParams::saturation_max_pir = atof(arg_vet[++i]);
+	    }
+	    else if (!strcmp(arg_vet[i], "-saturation_factor"))
+		NoximGlobalParams::saturation_factor = atof(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-steady")) {
+		NoximGlobalParams::steady_batch = atoi(arg_vet[++i]);
+		NoximGlobalParams::steady_tolerance = atof(arg_vet[++i]);
+	    }
+	    else if (!strcmp(arg_vet[i], "-campaign")) {
+		char *campaign = arg_vet[++i];
+		if (!strcmp(campaign, "list")) {
+		    NoximGlobalParams::campaign = CAMPAIGN_LIST;
+		    strcpy(NoximGlobalParams::campaign_filename, arg_vet[++i]);
+		} else if (!strcmp(campaign, "random")) {
+		    NoximGlobalParams::campaign = CAMPAIGN_RANDOM;
+		    NoximGlobalParams::campaign_runs = atoi(arg_vet[++i]);
+		    NoximGlobalParams::campaign_faults = atoi(arg_vet[++i]);
+		} else if (!strcmp(campaign, "all")) {
+		    NoximGlobalParams::campaign = CAMPAIGN_ALL;
+		    NoximGlobalParams::campaign_faults = atoi(arg_vet[++i]);
+		} else
+		    NoximGlobalParams::campaign = INVALID_CAMPAIGN;
+	    }
+	    else if (!strcmp(arg_vet[i], "-jobs"))
+		NoximGlobalParams::jobs = atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-branch"))
+		NoximGlobalParams::campaign_branch = true;
+	    else if (!strcmp(arg_vet[i], "-log")) {
+		NoximGlobalParams::log_level = atoi(arg_vet[++i]);
+		strcpy(NoximGlobalParams::log_filename, arg_vet[++i]);
+	    }
+	    else if (!strcmp(arg_vet[i], "-packet_trace")) {
+		NoximGlobalParams::packet_trace_records = atoi(arg_vet[++i]);
+		strcpy(NoximGlobalParams::packet_trace_filename, arg_vet[++i]);
+	    }
+	    else if (!strcmp(arg_vet[i], "-delay_histogram"))
+		strcpy(NoximGlobalParams::delay_histogram_filename, arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-snapshot")) {
+		NoximGlobalParams::snapshot_interval = atoi(arg_vet[++i]);
+		strcpy(NoximGlobalParams::snapshot_filename, arg_vet[++i]);
+	    }
+	    else if (!strcmp(arg_vet[i], "-save_checkpoint"))
+		strcpy(NoximGlobalParams::save_checkpoint_filename, arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-restore_checkpoint"))
+		strcpy(NoximGlobalParams::restore_checkpoint_filename, arg_vet[++i]);
 	    else {
 		cerr << "Error: Invalid option: " << arg_vet[i] << endl;
 		exit(1);
@@ -0,0 +1,205 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the steady state monitor
+ */
+
+#include <cmath>
+#include "NoximConvergence.h"
+
+// Two-sided 95% quantiles of the Student t distribution, by degrees of
+// freedom; the normal quantile is used beyond the table
+static const double student_t95[] = {
+    0.0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262,
+    2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093,
+    2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045,
+    2.042
+};
+
+NoximConvergenceMonitor::NoximConvergenceMonitor()
+{
+    configure(0, 0.0, 1, 0);
+}
+
+void NoximConvergenceMonitor::configure(const int _batch_cycles,
+					const double _tolerance,
+					const int _tiles, const int start)
+{
+    batch_cycles = _batch_cycles;
+    tolerance = _tolerance;
+    tiles = _tiles;
+    next_cycle = start + _batch_cycles;
+
+    last_cycle = start;
+    last_packets = 0;
+    last_delay_sum = 0.0;
+    last_flits = 0;
+
+    delays.clear();
+    throughputs.clear();
+
+    warm_up_cycle = -1;
+    truncated = 0;
+    warm_up_batches = 0;
+    converged = false;
+    converged_cycle = -1;
+}
+
+// MSER: for each truncation point d the standard error of the mean of the
+// batches after d, sum((x - mean)^2) / (n - d)^2. The sums are built from
+// the end of the series, so every d costs constant time
+bool NoximConvergenceMonitor::warmUpOver()
+{
+    unsigned int n = delays.size();
+
+    if (n < STEADY_MIN_BATCHES)
+	return false;
+
+    double sum = 0.0, sum_squares = 0.0;
+    double best = -1.0;
+    unsigned int best_d = 0;
+
+    for (unsigned int d = n; d-- > 0;) {
+	sum += delays[d];
+	sum_squares += delays[d] * delays[d];
+
+	if (d > n / 2)
+	    continue;
+
+	double k = n - d;
+	double mser = (sum_squares - sum * sum / k) / (k * k);
+
+	if (best < 0.0 || mser <= best) {
+	    best = mser;
+	    best_d = d;
+	}
+    }
+
+    if (best_d >= n / 2)
+	return false;
+
+    truncated = best_d;
+    return true;
+}
+
+NoximSteadyEstimate NoximConvergenceMonitor::estimate(const vector <
+						      double >&series)
+{
+    NoximSteadyEstimate e;
+    unsigned int n = series.size();
+
+    e.batches = n;
+    e.mean = 0.0;
+    e.half_width = -1.0;
+
+    if (n == 0)
+	return e;
+
+    for (unsigned int i = 0; i < n; i++)
+	e.mean += series[i];
+    e.mean /= n;
+
+    if (n < 2)
+	return e;
+
+    double variance = 0.0;
+    for (unsigned int i = 0; i < n; i++)
+	variance += (series[i] - e.mean) * (series[i] - e.mean);
+    variance /= n - 1;
+
+    double t = (n - 1 < sizeof(student_t95) / sizeof(double)) ?
+	student_t95[n - 1] : 1.96;
+
+    e.half_width = t * sqrt(variance / n);
+
+    return e;
+}
+
+NoximSteadyEstimate NoximConvergenceMonitor::getDelay() const
+{
+    return estimate(delays);
+}
+
+NoximSteadyEstimate NoximConvergenceMonitor::getThroughput() const
+{
+    return estimate(throughputs);
+}
+
+int NoximConvergenceMonitor::addBatch(const int cycle,
+				      const unsigned long packets,
+				      const double delay_sum,
+				      const unsigned long flits)
+{
+    int cycles = cycle - last_cycle;
+
+    if (packets > last_packets)
+	delays.push_back((delay_sum - last_delay_sum) /
+			 (packets - last_packets));
+    throughputs.push_back((double) (flits - last_flits) / cycles / tiles);
+
+    last_cycle = cycle;
+    last_packets = packets;
+    last_delay_sum = delay_sum;
+    last_flits = flits;
+    while (next_cycle <= cycle)
+	next_cycle += batch_cycles;
+
+    if (converged)
+	return STEADY_RUNNING;
+
+    if (!isWarmedUp()) {
+	warm_up_batches++;
+	if (!warmUpOver())
+	    return STEADY_RUNNING;
+
+	// The estimates start from the batches to come
+	warm_up_cycle = cycle;
+	delays.clear();
+	throughputs.clear();
+	return STEADY_WARMED_UP;
+    }
+
+    if (delays.size() < STEADY_MIN_BATCHES ||
+	throughputs.size() < STEADY_MIN_BATCHES)
+	return STEADY_RUNNING;
+
+    NoximSteadyEstimate d = getDelay();
+    NoximSteadyEstimate t = getThroughput();
+
+    if (d.half_width > tolerance * d.mean ||
+	t.half_width > tolerance * t.mean || t.mean <= 0.0)
+	return STEADY_RUNNING;
+
+    converged = true;
+    converged_cycle = cycle;
+    return STEADY_CONVERGED;
+}
+
+void NoximConvergenceMonitor::showReport(ostream & out) const
+{
+    if (!isWarmedUp()) {
+	out << "% Warm-up not over after " << warm_up_batches <<
+	    " batches" << endl;
+	return;
+    }
+
+    out << "% Warm-up over at cycle " << warm_up_cycle << " (MSER truncation "
+	<< truncated << " of " << warm_up_batches << " batches)" << endl;
+
+    NoximSteadyEstimate d = getDelay();
+    NoximSteadyEstimate t = getThroughput();
+
+    if (converged)
+	out << "% Steady state reached at cycle " << converged_cycle << endl;
+    else
+	out << "% Steady state not reached within the tolerance" << endl;
+
+    out << "% Steady state delay (cycles): " << d.mean << " +/- " <<
+	d.half_width << " over " << d.batches << " batches" << endl;
+    out << "% Steady state throughput (flits/cycle/IP): " << t.mean <<
+	" +/- " << t.half_width << " over " << t.batches << " batches" << endl;
+}
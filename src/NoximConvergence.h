@@ -0,0 +1,111 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the steady state monitor
+ */
+
+#ifndef __NOXIMCONVERGENCE_H__
+#define __NOXIMCONVERGENCE_H__
+
+#include <iostream>
+#include <vector>
+using namespace std;
+
+// Batches needed before the warm-up or the steady state can be declared
+#define STEADY_MIN_BATCHES     10
+
+// Outcome of a batch
+#define STEADY_RUNNING         0
+#define STEADY_WARMED_UP       1	// The warm-up ends with this batch
+#define STEADY_CONVERGED       2	// The estimates are within the tolerance
+
+// NoximSteadyEstimate -- mean of a series of batch means, with the half
+// width of its 95% confidence interval
+struct NoximSteadyEstimate {
+    unsigned int batches;
+    double mean;
+    double half_width;
+};
+
+// NoximConvergenceMonitor -- batch means of the delay of the delivered
+// packets and of the throughput, over batches of a fixed number of cycles.
+//
+// During the warm-up, the MSER rule is applied to the delay batch means
+// after every batch: the truncation point that minimizes the standard
+// error of the remaining batches is looked for in the first half of the
+// series, and the warm-up is over once it is found there (the transient
+// no longer dominates the series). From then on fresh batches are
+// collected, and the run has converged once the confidence intervals of
+// the mean delay and throughput are both within the tolerance, relative
+// to their means.
+class NoximConvergenceMonitor {
+
+  public:
+
+    NoximConvergenceMonitor();
+
+    // Batches of '_batch_cycles' cycles from 'start', over the given
+    // number of tiles. No batch at all if '_batch_cycles' is 0
+    void configure(const int _batch_cycles, const double _tolerance,
+		   const int _tiles, const int start);
+
+    inline bool enabled() const {
+	return batch_cycles > 0;
+    }
+
+    // Cycle at which the next batch ends
+    inline int nextCycle() const {
+	return next_cycle;
+    }
+
+    // Ends the batch at 'cycle' given the cumulative packets ejected from
+    // the network, the sum of their delays and the flits ejected.
+    // Returns STEADY_RUNNING, STEADY_WARMED_UP or STEADY_CONVERGED
+    int addBatch(const int cycle, const unsigned long packets,
+		 const double delay_sum, const unsigned long flits);
+
+    inline bool isWarmedUp() const {
+	return warm_up_cycle >= 0;
+    }
+
+    inline bool isConverged() const {
+	return converged;
+    }
+
+    // Estimates over the batches collected after the warm-up
+    NoximSteadyEstimate getDelay() const;
+    NoximSteadyEstimate getThroughput() const;
+
+    void showReport(ostream & out) const;
+
+  private:
+
+    int batch_cycles;
+    double tolerance;
+    int tiles;
+    int next_cycle;
+
+    // Cumulative figures at the end of the previous batch
+    int last_cycle;
+    unsigned long last_packets;
+    double last_delay_sum;
+    unsigned long last_flits;
+
+    vector < double >delays;	// Batch means, batches without packets left out
+    vector < double >throughputs;	// Flits per cycle per tile of every batch
+
+    int warm_up_cycle;		// -1 until the warm-up is over
+    unsigned int truncated;	// Batches dropped by the MSER rule
+    unsigned int warm_up_batches;	// Batches seen during the warm-up
+    bool converged;
+    int converged_cycle;
+
+    bool warmUpOver();
+    static NoximSteadyEstimate estimate(const vector < double >&series);
+};
+
+#endif
@@ -0,0 +1,70 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the binary event log
+ */
+
+#include <cstring>
+#include "NoximEventLog.h"
+
+NoximEventLog::NoximEventLog()
+{
+    file = NULL;
+    log_level = LOG_OFF;
+    buffer = NULL;
+    used = 0;
+}
+
+NoximEventLog::~NoximEventLog()
+{
+    close();
+}
+
+bool NoximEventLog::open(const char *fname, const int level)
+{
+    close();
+
+    file = fopen(fname, "wb");
+    if (file == NULL)
+	return false;
+
+    unsigned int version = LOG_VERSION;
+
+    if (fwrite(LOG_MAGIC, strlen(LOG_MAGIC), 1, file) != 1 ||
+	fwrite(&version, sizeof(version), 1, file) != 1) {
+	fclose(file);
+	file = NULL;
+	return false;
+    }
+
+    buffer = new NoximLogRecord[LOG_BUFFER_RECORDS];
+    used = 0;
+    log_level = level;
+
+    return true;
+}
+
+void NoximEventLog::close()
+{
+    if (file == NULL)
+	return;
+
+    flush();
+    fclose(file);
+    file = NULL;
+
+    delete[]buffer;
+    buffer = NULL;
+    log_level = LOG_OFF;
+}
+
+void NoximEventLog::flush()
+{
+    if (used > 0)
+	fwrite(buffer, sizeof(NoximLogRecord), used, file);
+    used = 0;
+}
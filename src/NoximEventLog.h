@@ -0,0 +1,101 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the binary event log
+ */
+
+#ifndef __NOXIMEVENTLOG_H__
+#define __NOXIMEVENTLOG_H__
+
+// Only standard headers: the decoder in ../other includes this file too
+#include <cstdio>
+
+// Log levels: each one logs the events of the previous ones too
+#define LOG_OFF                0
+#define LOG_STATES             1	// Final state of every packet
+#define LOG_PACKETS            2	// Creation and sending of every packet
+#define LOG_ROUTING            3	// Routing decisions without a path
+
+// Event types, with the meaning of the id and value of their records
+#define EVENT_PACKET_STATE     0	// Packet id, final state
+#define EVENT_PACKET_CREATED   1	// PE id, packet id
+#define EVENT_PACKET_SENT      2	// Packet id, destination id
+#define EVENT_NO_PATH          3	// Router id, no path message
+
+// The file starts with the magic string and the format version, then
+// holds the records in the order the events took place
+#define LOG_MAGIC              "NOXIMLOG"
+#define LOG_VERSION            1
+
+// Records kept in memory before being written out
+#define LOG_BUFFER_RECORDS     65536
+
+// NoximLogRecord -- one event, as stored in the file
+struct NoximLogRecord {
+    unsigned int cycle;
+    unsigned int type;
+    int id;
+    int value;
+};
+
+// NoximEventLog -- typed events written to a binary file through a
+// buffer. Events above the level of the log are dropped at the cost of
+// one comparison, so a closed log (level LOG_OFF) costs nothing else.
+//
+// The log is written by one thread only: routers running in the worker
+// threads of the native engine defer their events like the other
+// updates to the global bookkeeping.
+class NoximEventLog {
+
+  public:
+
+    NoximEventLog();
+    ~NoximEventLog();
+
+    // Start logging the events up to the given level. Returns false if
+    // the file cannot be created
+    bool open(const char *fname, const int level);
+
+    // Write out the buffered events and stop logging
+    void close();
+
+    inline bool enabled(const int level) const {
+	return level <= log_level;
+    }
+
+    inline void write(const int level, const unsigned int cycle,
+		      const int type, const int id, const int value) {
+	if (level > log_level)
+	    return;
+
+	if (used == LOG_BUFFER_RECORDS)
+	    flush();
+
+	NoximLogRecord & record = buffer[used++];
+
+	record.cycle = cycle;
+	record.type = type;
+	record.id = id;
+	record.value = value;
+    }
+
+  private:
+
+    FILE *file;
+    int log_level;
+    NoximLogRecord *buffer;
+    unsigned int used;		// Records in the buffer
+
+    void flush();
+
+    NoximEventLog(const NoximEventLog &);
+    NoximEventLog & operator=(const NoximEventLog &);
+};
+
+extern NoximEventLog EventLog;
+
+#endif
@@ -0,0 +1,105 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the schedule of fault events
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+#include <algorithm>
+#include "NoximFaultSchedule.h"
+
+// Events of the same cycle keep the order of the file
+static bool earlier(const NoximFaultEvent & a, const NoximFaultEvent & b)
+{
+    return a.cycle < b.cycle;
+}
+
+static bool validId(const int id)
+{
+    return id >= 0 &&
+	id < NoximGlobalParams::mesh_dim_x * NoximGlobalParams::mesh_dim_y;
+}
+
+NoximFaultSchedule::NoximFaultSchedule():next_event(0)
+{
+}
+
+void NoximFaultSchedule::addEvents(const int id, const int neighbor,
+				   const int fail, const int recover)
+{
+    NoximFaultEvent event;
+
+    event.cycle = fail;
+    event.id = id;
+    event.neighbor = neighbor;
+    event.faulty = true;
+    events.push_back(event);
+
+    if (recover >= 0) {
+	event.cycle = recover;
+	event.faulty = false;
+	events.push_back(event);
+    }
+}
+
+bool NoximFaultSchedule::load(const char *fname)
+{
+    ifstream fin(fname, ios::in);
+    if (!fin) {
+	cerr << "Error: cannot open the fault file " << fname << endl;
+	return false;
+    }
+
+    events.clear();
+    next_event = 0;
+
+    char line[512];
+    for (int n = 1; fin.getline(line, sizeof(line)); n++) {
+	char kind[16];
+	int a, b, c, d;
+
+	if (line[0] == '%' || sscanf(line, "%15s", kind) != 1)
+	    continue;
+
+	int params = sscanf(line, "%15s %d %d %d %d", kind, &a, &b, &c, &d);
+	bool ok = false;
+
+	if (!strcmp(kind, "router") && (params == 3 || params == 4)) {
+	    // router ID FAIL [RECOVER]
+	    int recover = params == 4 ? c : -1;
+
+	    ok = validId(a) && b >= 0 && (recover < 0 || recover > b);
+	    if (ok)
+		addEvents(a, NOT_VALID, b, recover);
+	} else if (!strcmp(kind, "link") && (params == 4 || params == 5)) {
+	    // link ID1 ID2 FAIL [RECOVER]
+	    int recover = params == 5 ? d : -1;
+
+	    ok = validId(a) && validId(b) && c >= 0 &&
+		(recover < 0 || recover > c);
+	    if (ok) {
+		NoximCoord ca = id2Coord(a), cb = id2Coord(b);
+		ok = abs(ca.x - cb.x) + abs(ca.y - cb.y) == 1;
+	    }
+	    if (ok)
+		addEvents(a, b, c, recover);
+	}
+
+	if (!ok) {
+	    cerr << "Error: " << fname << ":" << n <<
+		": invalid fault event '" << line << "'" << endl;
+	    return false;
+	}
+    }
+
+    stable_sort(events.begin(), events.end(), earlier);
+
+    return true;
+}
@@ -0,0 +1,72 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the schedule of fault events
+ */
+
+#ifndef __NOXIMFAULTSCHEDULE_H__
+#define __NOXIMFAULTSCHEDULE_H__
+
+#include <vector>
+#include "NoximMain.h"
+using namespace std;
+
+// NoximFaultEvent -- a router or a link failing or recovering
+struct NoximFaultEvent {
+    int cycle;			// Cycle at which the event takes place
+    int id;			// Router, or first end of the link
+    int neighbor;		// Second end of the link, NOT_VALID for a router
+    bool faulty;		// Fails (true) or recovers (false)
+};
+
+// NoximFaultSchedule -- fault events read from a file, sorted by cycle.
+// Each line of the file is one of
+//
+//   router ID FAIL_CYCLE [RECOVER_CYCLE]
+//   link ID1 ID2 FAIL_CYCLE [RECOVER_CYCLE]
+//
+// where the ends of a link are neighbor routers. Lines starting with %
+// are comments.
+class NoximFaultSchedule {
+
+  public:
+
+    NoximFaultSchedule();
+
+    // Load the events from file. Errors are reported on cerr; returns
+    // true if ok, false otherwise
+    bool load(const char *fname);
+
+    // Next event still to be applied, NULL if none
+    inline const NoximFaultEvent *next() const {
+	return next_event < events.size() ? &events[next_event] : NULL;
+    }
+
+    // Mark the next event as applied
+    inline void pop() {
+	next_event++;
+    }
+
+    // Make every event pending again
+    void rewind() {
+	next_event = 0;
+    }
+
+    unsigned int size() const {
+	return events.size();
+    }
+
+  private:
+
+    vector < NoximFaultEvent > events;
+    unsigned int next_event;
+
+    void addEvents(const int id, const int neighbor, const int fail,
+		   const int recover);
+};
+
+#endif
@@ -0,0 +1,106 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the flit arena
+ */
+
+#include "NoximFlitArena.h"
+
+// Minimum number of slots of a chunk (log2)
+#define MIN_CHUNK_SHIFT 12
+
+NoximFlitArena::NoximFlitArena()
+{
+    block_shift = 0;
+    chunk_shift = MIN_CHUNK_SHIFT;
+    chunk_mask = (1U << chunk_shift) - 1;
+    next_block = 0;
+}
+
+NoximFlitArena::~NoximFlitArena()
+{
+    for (unsigned int i = 0; i < chunks.size(); i++)
+	delete[]chunks[i];
+}
+
+void NoximFlitArena::configure(const int max_packet_size)
+{
+    assert(chunks.empty());
+
+    block_shift = 0;
+    while ((1 << block_shift) < max_packet_size)
+	block_shift++;
+
+    chunk_shift = block_shift > MIN_CHUNK_SHIFT ? block_shift : MIN_CHUNK_SHIFT;
+    chunk_mask = (1U << chunk_shift) - 1;
+
+    // Block 0 holds the blank flit behind handle 0
+    allocatePacket();
+}
+
+NoximFlitHandle NoximFlitArena::allocatePacket()
+{
+    unsigned int block;
+
+    if (!free_blocks.empty()) {
+	block = free_blocks.back();
+	free_blocks.pop_back();
+    } else {
+	block = next_block++;
+
+	NoximFlitHandle first = (NoximFlitHandle) block << block_shift;
+	if ((first >> chunk_shift) == chunks.size()) {
+	    assert(chunks.size() < (1ULL << (32 - chunk_shift)));
+	    chunks.push_back(new NoximFlit[chunk_mask + 1]());
+	}
+    }
+
+    return (NoximFlitHandle) block << block_shift;
+}
+
+void NoximFlitArena::releasePacket(const NoximFlitHandle handle)
+{
+    unsigned int block = handle >> block_shift;
+
+    assert(block != 0 && block < next_block);
+    free_blocks.push_back(block);
+}
+
+void NoximFlitArena::clear()
+{
+    // Block 0 stays taken by the blank flit
+    free_blocks.clear();
+    next_block = 1;
+}
+
+void NoximFlitArena::checkpoint(NoximCheckpoint & cp)
+{
+    cp.transfer(free_blocks);
+    cp.transfer(next_block);
+
+    // Flits of the blocks up to the last one handed out, chunk by chunk.
+    // Chunks are allocated as their flits are read, so that a corrupted
+    // block count cannot exhaust the memory
+    unsigned long long slots = (unsigned long long) next_block << block_shift;
+
+    for (unsigned int i = 0;
+	 cp.good() && ((unsigned long long) i << chunk_shift) < slots; i++) {
+	if (i == chunks.size()) {
+	    assert(chunks.size() < (1ULL << (32 - chunk_shift)));
+	    chunks.push_back(new NoximFlit[chunk_mask + 1]());
+	}
+
+	unsigned long long left = slots - ((unsigned long long) i << chunk_shift);
+	cp.transfer(chunks[i], (size_t) min(left, (unsigned long long) chunk_mask + 1));
+    }
+}
+
+size_t NoximFlitArena::getMemory() const
+{
+    return chunks.size() * (chunk_mask + 1) * sizeof(NoximFlit) +
+	free_blocks.capacity() * sizeof(unsigned int);
+}
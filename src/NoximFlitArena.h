@@ -0,0 +1,69 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the flit arena
+ */
+
+#ifndef __NOXIMFLITARENA_H__
+#define __NOXIMFLITARENA_H__
+
+#include <vector>
+#include "NoximMain.h"
+#include "NoximCheckpoint.h"
+using namespace std;
+
+// NoximFlitArena -- storage of every flit in flight. Each packet takes a
+// block of consecutive slots, so the flit with sequence number k is at
+// the handle of the head plus k. Blocks are carved out of fixed chunks
+// that never move and are recycled as a whole once the packet has been
+// delivered. Handle 0 is a blank flit, seen by links never written.
+class NoximFlitArena {
+
+  public:
+
+    NoximFlitArena();
+    ~NoximFlitArena();
+
+    // Set the block size, must be called before any allocation
+    void configure(const int max_packet_size);
+
+    // Handle of the head flit of a new block of max_packet_size flits
+    NoximFlitHandle allocatePacket();
+
+    // Give back the block holding the flit (any flit of the packet)
+    void releasePacket(const NoximFlitHandle handle);
+
+    // Give back every block, keeping the chunks for the next allocations
+    void clear();
+
+    inline NoximFlit & operator[] (const NoximFlitHandle handle) {
+	return chunks[handle >> chunk_shift][handle & chunk_mask];
+    }
+
+    // Save the blocks handed out so far, or restore them
+    void checkpoint(NoximCheckpoint & cp);
+
+    // Bytes allocated for the chunks
+    size_t getMemory() const;
+
+  private:
+
+    unsigned int block_shift;	// log2 of the slots of a block
+    unsigned int chunk_shift;	// log2 of the slots of a chunk
+    unsigned int chunk_mask;
+
+    vector < NoximFlit * >chunks;
+    vector < unsigned int >free_blocks;	// Released blocks, reused first
+    unsigned int next_block;	// First block never handed out
+
+    NoximFlitArena(const NoximFlitArena &);
+    NoximFlitArena & operator=(const NoximFlitArena &);
+};
+
+extern NoximFlitArena FlitArena;
+
+#endif
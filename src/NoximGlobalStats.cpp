@@ -8,6 +8,7 @@
  * This file contains the implementaton of the global statistics
  */
 
+#include <cstring>
 #include "NoximGlobalStats.h"
 using namespace std;
 
@@ -211,6 +212,17 @@ vector < vector < unsigned long > > NoximGlobalStats::getRoutedFlitsMtx()
     return mtx;
 }
 
+NoximHistogram NoximGlobalStats::getDelayHistogram()
+{
+    NoximHistogram h;
+
+    for (int y = 0; y < NoximGlobalParams::mesh_dim_y; y++)
+	for (int x = 0; x < NoximGlobalParams::mesh_dim_x; x++)
+	    h.merge(noc->t[x][y]->r->stats.getDelayHistogram());
+
+    return h;
+}
+
 double NoximGlobalStats::getPower()
 {
     double power = 0.0;
@@ -235,6 +247,11 @@ void NoximGlobalStats::showStats(std::ostream & out, bool detailed)
 	getAverageThroughput() << endl;
     out << "% Throughput (flits/cycle/IP): " << getThroughput() << endl;
     out << "% Max delay (cycles): " << getMaxDelay() << endl;
+
+    NoximHistogram h = getDelayHistogram();
+    out << "% Delay percentiles p50 p90 p99 p99.9 (cycles): " <<
+	h.getPercentile(50.0) << " " << h.getPercentile(90.0) << " " <<
+	h.getPercentile(99.0) << " " << h.getPercentile(99.9) << endl;
     out << "% Total energy (J): " << getPower() << endl;
 
     if (NoximGlobalParams::show_buffer_stats)
@@ -262,6 +279,24 @@ void NoximGlobalStats::showStats(std::ostream & out, bool detailed)
 	}
 	out << "];" << endl;
 
+	// show the delay percentiles of each destination
+	out << endl << "% dst p50 p90 p99 p99.9" << endl;
+	out << "delay_percentiles = [" << endl;
+	for (int y = 0; y < NoximGlobalParams::mesh_dim_y; y++)
+	    for (int x = 0; x < NoximGlobalParams::mesh_dim_x; x++) {
+		const NoximHistogram & dh =
+		    noc->t[x][y]->r->stats.getDelayHistogram();
+
+		if (dh.getCount() == 0)
+		    continue;
+		out << "   " << setw(5) << y * NoximGlobalParams::mesh_dim_x + x
+		    << setw(8) << dh.getPercentile(50.0)
+		    << setw(8) << dh.getPercentile(90.0)
+		    << setw(8) << dh.getPercentile(99.0)
+		    << setw(8) << dh.getPercentile(99.9) << endl;
+	    }
+	out << "];" << endl;
+
 	// show RoutedFlits matrix
 	vector < vector < unsigned long > > rf_mtx = getRoutedFlitsMtx();
 
@@ -289,3 +324,67 @@ void NoximGlobalStats::showBufferStats(std::ostream & out)
 	out << endl;
       }
 }
+
+void NoximGlobalStats::showDelayHistograms(std::ostream & out)
+{
+    // Blocks separated by two blank lines, as gnuplot indexes them
+    out << "# all destinations" << endl;
+    out << "# lowest highest count" << endl;
+    getDelayHistogram().show(out);
+
+    for (int y = 0; y < NoximGlobalParams::mesh_dim_y; y++)
+	for (int x = 0; x < NoximGlobalParams::mesh_dim_x; x++) {
+	    out << endl << endl << "# destination " <<
+		y * NoximGlobalParams::mesh_dim_x + x << endl;
+	    noc->t[x][y]->r->stats.getDelayHistogram().show(out);
+	}
+}
+
+// FNV-1a hash, used to fold per-router and per-packet figures
+static void hashBytes(unsigned long long &hash, const void *data,
+		      const size_t size)
+{
+    const unsigned char *p = (const unsigned char *) data;
+
+    for (size_t i = 0; i < size; i++) {
+	hash ^= p[i];
+	hash *= 1099511628211ULL;
+    }
+}
+
+void NoximGlobalStats::getDigest(NoximStatsDigest & digest)
+{
+    memset(&digest, 0, sizeof(digest));
+
+    digest.cycles = getCurrentCycle();
+    digest.sent_packets = SentPacketNumber;
+    digest.received_packets = ReceiveNumber;
+    digest.created_packets = PacketRegistry.size();
+    digest.delivered_packets = PacketRegistry.getDelivered();
+    digest.received_flits = getReceivedFlits();
+    digest.average_delay = getAverageDelay();
+    digest.max_delay = getMaxDelay();
+    digest.average_throughput = getAverageThroughput();
+    digest.throughput = getThroughput();
+    digest.power = getPower();
+
+    digest.routers_hash = 14695981039346656037ULL;
+    for (int y = 0; y < NoximGlobalParams::mesh_dim_y; y++)
+	for (int x = 0; x < NoximGlobalParams::mesh_dim_x; x++) {
+	    NoximRouter *r = noc->t[x][y]->r;
+	    unsigned long routed_flits = r->getRoutedFlits();
+	    unsigned int received_flits = r->stats.getReceivedFlits();
+	    double power = r->getPower();
+
+	    hashBytes(digest.routers_hash, &routed_flits, sizeof(routed_flits));
+	    hashBytes(digest.routers_hash, &received_flits, sizeof(received_flits));
+	    hashBytes(digest.routers_hash, &power, sizeof(power));
+	}
+
+    digest.packets_hash = 14695981039346656037ULL;
+    digest.no_path_packets = PacketRegistry.getCount(STATE_NO_PATH);
+    for (unsigned int i = 0; i < PacketRegistry.size(); i++) {
+	int state = PacketRegistry.getState(i);
+	hashBytes(digest.packets_hash, &state, sizeof(int));
+    }
+}
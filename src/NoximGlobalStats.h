@@ -18,6 +18,25 @@
 #include "NoximTile.h"
 using namespace std;
 
+// NoximStatsDigest -- end of simulation figures compared, bit by bit,
+// by the engine verification mode
+struct NoximStatsDigest {
+    double cycles;			// Simulated cycles at the end of the run
+    unsigned int sent_packets;
+    unsigned int received_packets;
+    unsigned int created_packets;	// Whatever the cap on the sent packets
+    unsigned int delivered_packets;	// Tail flit ejected at the destination
+    unsigned int received_flits;
+    unsigned int no_path_packets;
+    double average_delay;
+    double max_delay;
+    double average_throughput;
+    double throughput;
+    double power;
+    unsigned long long routers_hash;	// Per-router counters and energy
+    unsigned long long packets_hash;	// Final state of every packet
+};
+
 class NoximGlobalStats {
 
   public:
@@ -41,6 +60,10 @@ class NoximGlobalStats {
     // Returns the max delay (cycles) for communication src_id->dst_id
     double getMaxDelay(const int src_id, const int dst_id);
 
+    // Returns the histogram of the delays of all the received packets,
+    // merged from those of the destinations
+    NoximHistogram getDelayHistogram();
+
     // Returns tha matrix of max delay for any node of the network
      vector < vector < double > > getMaxDelayMtx();
 
@@ -71,6 +94,12 @@ class NoximGlobalStats {
 
     void showBufferStats(std::ostream & out);
 
+    // Shows the global delay histogram, then the one of each destination
+    void showDelayHistograms(std::ostream & out);
+
+    // Collects the figures compared by the engine verification mode
+    void getDigest(NoximStatsDigest & digest);
+
 #ifdef TESTING
     unsigned int drained_total;
 #endif
@@ -127,6 +127,31 @@ double NoximGlobalTrafficTable::getCumulativePirPor(const int src_id,
   return cpirnpor;
 }
 
+int NoximGlobalTrafficTable::getNextChange(const int src_id,
+					   const int ccycle)
+{
+  int next = INT_MAX;
+
+  for (unsigned int i = 0; i < traffic_table.size(); i++) {
+    NoximCommunication comm = traffic_table[i];
+    if (comm.src == src_id) {
+      // Active while t_on < r_ccycle < t_off, see getCumulativePirPor()
+      int r_ccycle = ccycle % comm.t_period;
+      int edges[2] = { comm.t_on + 1, comm.t_off };
+
+      for (int e = 0; e < 2; e++) {
+	int distance = (edges[e] - r_ccycle) % comm.t_period;
+	if (distance <= 0)
+	  distance += comm.t_period;
+	if (ccycle + distance < next)
+	  next = ccycle + distance;
+      }
+    }
+  }
+
+  return next;
+}
+
 int NoximGlobalTrafficTable::occurrencesAsSource(const int src_id)
 {
   int count = 0;
@@ -47,6 +47,10 @@ class NoximGlobalTrafficTable {
 			       vector < pair < int, double > > &dst_prob,
 			       vector <bool> &use_low_voltage_path);
 
+    // Returns the first cycle after ccycle at which the communications
+    // of source src_id may be switched on or off
+    int getNextChange(const int src_id, const int ccycle);
+
     // Returns the number of occurrences of soruce src_id in the traffic
     // table
     int occurrencesAsSource(const int src_id);
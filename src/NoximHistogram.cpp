@@ -0,0 +1,133 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the delay histogram
+ */
+
+#include <cmath>
+#include "NoximHistogram.h"
+
+NoximHistogram::NoximHistogram()
+{
+    clear();
+}
+
+void NoximHistogram::clear()
+{
+    buckets.clear();
+    count = 0;
+    min_value = 0;
+    max_value = 0;
+}
+
+// Values below 2 * HISTOGRAM_SUB_BUCKETS have a bucket each. Above, the
+// values with their highest bit in position b (b > HISTOGRAM_SUB_BITS)
+// are split by their HISTOGRAM_SUB_BITS bits after the highest one
+unsigned int NoximHistogram::bucketOf(const unsigned long value)
+{
+    if (value < 2 * HISTOGRAM_SUB_BUCKETS)
+	return value;
+
+    unsigned int shift = 0;
+    while ((value >> shift) >= 2 * HISTOGRAM_SUB_BUCKETS)
+	shift++;
+
+    return (shift + 1) * HISTOGRAM_SUB_BUCKETS + (value >> shift) -
+	HISTOGRAM_SUB_BUCKETS;
+}
+
+unsigned long NoximHistogram::lowestOf(const unsigned int bucket)
+{
+    if (bucket < 2 * HISTOGRAM_SUB_BUCKETS)
+	return bucket;
+
+    unsigned int shift = bucket / HISTOGRAM_SUB_BUCKETS - 1;
+    unsigned long sub = bucket % HISTOGRAM_SUB_BUCKETS + HISTOGRAM_SUB_BUCKETS;
+
+    return sub << shift;
+}
+
+unsigned long NoximHistogram::highestOf(const unsigned int bucket)
+{
+    return lowestOf(bucket + 1) - 1;
+}
+
+void NoximHistogram::record(const double value)
+{
+    unsigned long v = value > 0.0 ? (unsigned long) floor(value + 0.5) : 0;
+    unsigned int b = bucketOf(v);
+
+    if (b >= buckets.size())
+	buckets.resize(b + 1, 0);
+    buckets[b]++;
+
+    if (count == 0 || v < min_value)
+	min_value = v;
+    if (v > max_value)
+	max_value = v;
+    count++;
+}
+
+void NoximHistogram::merge(const NoximHistogram & h)
+{
+    if (h.count == 0)
+	return;
+
+    if (h.buckets.size() > buckets.size())
+	buckets.resize(h.buckets.size(), 0);
+    for (unsigned int b = 0; b < h.buckets.size(); b++)
+	buckets[b] += h.buckets[b];
+
+    if (count == 0 || h.min_value < min_value)
+	min_value = h.min_value;
+    if (h.max_value > max_value)
+	max_value = h.max_value;
+    count += h.count;
+}
+
+double NoximHistogram::getPercentile(const double percent) const
+{
+    if (count == 0)
+	return -1.0;
+
+    // Rank of the value, from 1 to count
+    unsigned long rank = (unsigned long) ceil(percent / 100.0 * count);
+    if (rank < 1)
+	rank = 1;
+
+    unsigned long seen = 0;
+    for (unsigned int b = 0; b < buckets.size(); b++) {
+	seen += buckets[b];
+	if (seen >= rank) {
+	    // The extremes are known exactly
+	    unsigned long v = highestOf(b);
+	    if (v > max_value)
+		v = max_value;
+	    if (v < min_value)
+		v = min_value;
+	    return (double) v;
+	}
+    }
+
+    return (double) max_value;
+}
+
+void NoximHistogram::show(std::ostream & out) const
+{
+    for (unsigned int b = 0; b < buckets.size(); b++)
+	if (buckets[b])
+	    out << lowestOf(b) << " " << highestOf(b) << " " << buckets[b] <<
+		endl;
+}
+
+void NoximHistogram::checkpoint(NoximCheckpoint & cp)
+{
+    cp.transfer(buckets);
+    cp.transfer(count);
+    cp.transfer(min_value);
+    cp.transfer(max_value);
+}
@@ -0,0 +1,77 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the delay histogram
+ */
+
+#ifndef __NOXIMHISTOGRAM_H__
+#define __NOXIMHISTOGRAM_H__
+
+#include <iostream>
+#include <vector>
+#include "NoximCheckpoint.h"
+using namespace std;
+
+// Each power of two above 2 * HISTOGRAM_SUB_BUCKETS is split into this
+// many buckets, so the width of a bucket is at most 1/32 of its values
+#define HISTOGRAM_SUB_BITS     5
+#define HISTOGRAM_SUB_BUCKETS  (1 << HISTOGRAM_SUB_BITS)
+
+// NoximHistogram -- counts of the delays (cycles, rounded to integers) in
+// logarithmic buckets: exact up to 2 * HISTOGRAM_SUB_BUCKETS, then with a
+// relative error below 1/HISTOGRAM_SUB_BUCKETS. The buckets are allocated
+// up to the largest value recorded only, and two histograms are merged by
+// adding their counts, so no sample is kept.
+class NoximHistogram {
+
+  public:
+
+    NoximHistogram();
+
+    void clear();
+
+    void record(const double value);
+
+    // Adds the counts of another histogram
+    void merge(const NoximHistogram & h);
+
+    inline unsigned long getCount() const {
+	return count;
+    } 
+
+    inline unsigned long getMin() const {
+	return min_value;
+    }
+
+    inline unsigned long getMax() const {
+	return max_value;
+    }
+
+    // Returns the smallest value v such that at least 'percent' % of the
+    // recorded values are not above v, up to the width of its bucket.
+    // Returns -1 if nothing has been recorded
+    double getPercentile(const double percent) const;
+
+    // Writes one "lowest highest count" line per non empty bucket
+    void show(std::ostream & out) const;
+
+    // Save the counts, or restore them
+    void checkpoint(NoximCheckpoint & cp);
+
+  private:
+
+    vector < unsigned long >buckets;
+    unsigned long count;
+    unsigned long min_value;
+    unsigned long max_value;
+
+    static unsigned int bucketOf(const unsigned long value);
+    static unsigned long lowestOf(const unsigned int bucket);
+    static unsigned long highestOf(const unsigned int bucket);
+};
+
+#endif
@@ -8,25 +8,44 @@
  * This file contains the implementation of the top-level of Noxim
  */
 
+#include <cmath>
+#include <fstream>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
 #include "NoximMain.h"
 #include "NoximNoC.h"
+#include "NoximNativeEngine.h"
 #include "NoximGlobalStats.h"
 #include "NoximCmdLineParser.h"
+#include "NoximCampaign.h"
+#include "NoximSaturation.h"
+#include "NoximReachability.h"
+#include "NoximPacketTrace.h"
+#include "NoximCheckpoint.h"
 using namespace std;
 
-int j=0;
 vector < int > FaultRouter;
 int SentPacketNumber;
+int packet_budget_start;
+bool packet_cap_lifted;
 //vector < int > Path;
-int PackedIndex;
-vector < int > PacketState;
 int ReceiveNumber;
+NoximFlitArena FlitArena;
+NoximNegativeFirstTable NegativeFirstTable;
+NoximPacketRegistry PacketRegistry;
+NoximEventLog EventLog;
+NoximPacketTrace PacketTrace;
 
 // vector < int > PacketPath;
 // vector<vector < int > > Path;
 // need to be globally visible to allow "-volume" simulation stop
 unsigned int drained_volume;
 
+// time and stop request of the native engine
+double native_time;
+bool native_stop;
+
 // Initialize global configuration parameters (can be overridden with command-line arguments)
 int NoximGlobalParams::verbose_mode = DEFAULT_VERBOSE_MODE;
 int NoximGlobalParams::trace_mode = DEFAULT_TRACE_MODE;
@@ -54,12 +73,155 @@ char NoximGlobalParams::router_power_filename[128] = DEFAULT_ROUTER_PWR_FILENAME
 bool NoximGlobalParams::low_power_link_strategy = DEFAULT_LOW_POWER_LINK_STRATEGY;
 double NoximGlobalParams::qos = DEFAULT_QOS;
 bool NoximGlobalParams::show_buffer_stats = DEFAULT_SHOW_BUFFER_STATS;
+int NoximGlobalParams::engine = DEFAULT_ENGINE;
+int NoximGlobalParams::threads = DEFAULT_THREADS;
+bool NoximGlobalParams::fast_forward = DEFAULT_FAST_FORWARD;
+bool NoximGlobalParams::routing_check = DEFAULT_ROUTING_CHECK;
+char NoximGlobalParams::faults_filename[128] = DEFAULT_FAULTS_FILENAME;
+bool NoximGlobalParams::reachability = DEFAULT_REACHABILITY;
+int NoximGlobalParams::campaign = DEFAULT_CAMPAIGN;
+char NoximGlobalParams::campaign_filename[128] = DEFAULT_CAMPAIGN_FILENAME;
+int NoximGlobalParams::campaign_runs = DEFAULT_CAMPAIGN_RUNS;
+int NoximGlobalParams::campaign_faults = DEFAULT_CAMPAIGN_FAULTS;
+int NoximGlobalParams::jobs = DEFAULT_JOBS;
+bool NoximGlobalParams::campaign_branch = DEFAULT_CAMPAIGN_BRANCH;
+int NoximGlobalParams::log_level = DEFAULT_LOG_LEVEL;
+char NoximGlobalParams::log_filename[128] = DEFAULT_LOG_FILENAME;
+int NoximGlobalParams::packet_trace_records = DEFAULT_PACKET_TRACE_RECORDS;
+char NoximGlobalParams::packet_trace_filename[128] = DEFAULT_PACKET_TRACE_FILENAME;
+char NoximGlobalParams::delay_histogram_filename[128] =
+    DEFAULT_DELAY_HISTOGRAM_FILENAME;
+int NoximGlobalParams::snapshot_interval = DEFAULT_SNAPSHOT_INTERVAL;
+char NoximGlobalParams::snapshot_filename[128] = DEFAULT_SNAPSHOT_FILENAME;
+bool NoximGlobalParams::saturation = DEFAULT_SATURATION;
+float NoximGlobalParams::saturation_min_pir = DEFAULT_SATURATION_MIN_PIR;
+float NoximGlobalParams::saturation_max_pir = DEFAULT_SATURATION_MAX_PIR;
+float NoximGlobalParams::saturation_factor = DEFAULT_SATURATION_FACTOR;
+int NoximGlobalParams::steady_batch = DEFAULT_STEADY_BATCH;
+double NoximGlobalParams::steady_tolerance = DEFAULT_STEADY_TOLERANCE;
+char NoximGlobalParams::save_checkpoint_filename[128] = DEFAULT_SAVE_CHECKPOINT_FILENAME;
+char NoximGlobalParams::restore_checkpoint_filename[128] = DEFAULT_RESTORE_CHECKPOINT_FILENAME;
                                   
 //---------------------------------------------------------------------------
 
+// Compares the digest of the native run with the one of the SystemC run
+static bool checkDigests(const NoximStatsDigest & native,
+			 const NoximStatsDigest & systemc)
+{
+    bool match = true;
+
+#define CHECK_FIELD(field) \
+    if (memcmp(&native.field, &systemc.field, sizeof(native.field))) { \
+	cout << "  " #field ": native " << native.field \
+	     << ", systemc " << systemc.field << endl; \
+	match = false; \
+    }
+
+    CHECK_FIELD(cycles);
+    CHECK_FIELD(sent_packets);
+    CHECK_FIELD(received_packets);
+    CHECK_FIELD(created_packets);
+    CHECK_FIELD(delivered_packets);
+    CHECK_FIELD(received_flits);
+    CHECK_FIELD(no_path_packets);
+    CHECK_FIELD(average_delay);
+    CHECK_FIELD(max_delay);
+    CHECK_FIELD(average_throughput);
+    CHECK_FIELD(throughput);
+    CHECK_FIELD(power);
+    CHECK_FIELD(routers_hash);
+    CHECK_FIELD(packets_hash);
+
+#undef CHECK_FIELD
+
+    return match;
+}
+
+// Resident set size of the process in bytes (0 if not available)
+static size_t residentMemory()
+{
+    unsigned long pages_total, pages_resident;
+    FILE *f = fopen("/proc/self/statm", "r");
+
+    if (f == NULL)
+	return 0;
+    if (fscanf(f, "%lu %lu", &pages_total, &pages_resident) != 2)
+	pages_resident = 0;
+    fclose(f);
+
+    return (size_t) pages_resident * sysconf(_SC_PAGESIZE);
+}
+
+// Memory taken by each subsystem after elaboration
+static void showMemoryReport(const NoximNoC * n,
+			     const NoximNativeEngine * engine,
+			     const double elaboration_time)
+{
+    cout << "Elaborated " << NoximGlobalParams::mesh_dim_x << "x"
+	<< NoximGlobalParams::mesh_dim_y << " mesh in "
+	<< elaboration_time << " s" << endl;
+    cout << "  tiles:        " << n->getTilesMemory() / 1024 << " KB" << endl;
+    cout << "  signals:      " << n->getSignalsMemory() / 1024 << " KB" << endl;
+    cout << "  flit arena:   " << FlitArena.getMemory() / 1024 << " KB" << endl;
+    if (NoximGlobalParams::routing_algorithm ==
+	ROUTING_NEGATIVE_FIRST_FAULT_TOLERANCE)
+	cout << "  routing:      " << NegativeFirstTable.getMemory() / 1024
+	    << " KB" << endl;
+    if (engine)
+	cout << "  native links: " << engine->getMemory() / 1024 << " KB" << endl;
+
+    size_t rss = residentMemory();
+    if (rss > 0)
+	cout << "  resident:     " << rss / 1024 << " KB" << endl;
+}
+
+// Writes the state of the simulation to the checkpoint file
+static void saveCheckpoint(NoximNoC * n, NoximNativeEngine * engine,
+			   const char *fname)
+{
+    NoximCheckpoint cp;
+
+    // Shorter than -sim if the packets ran out
+    int simulated_cycles = (int) ceil(getCurrentCycle()) - DEFAULT_RESET_TIME;
+
+    if (!cp.create(fname, simulated_cycles)) {
+	cerr << "Error: cannot create the checkpoint " << fname << endl;
+	exit(1);
+    }
+
+    engine->checkpoint(cp);
+    n->checkpoint(cp);
+
+    if (!cp.close()) {
+	cerr << "Error: cannot write the checkpoint " << fname << endl;
+	exit(1);
+    }
+}
+
+// Brings the simulation back to the state saved in the checkpoint file.
+// Returns the cycles simulated after the reset before it was saved
+static int restoreCheckpoint(NoximNoC * n, NoximNativeEngine * engine,
+			     const char *fname)
+{
+    NoximCheckpoint cp;
+
+    if (!cp.open(fname))
+	exit(1);
+
+    engine->checkpoint(cp);
+    n->checkpoint(cp);
+
+    if (!cp.close()) {
+	cerr << "Error: " << fname << " is truncated or corrupted" << endl;
+	exit(1);
+    }
+    engine->resume();
+
+    return cp.getHeader().simulated_cycles;
+}
+
 int sc_main(int arg_num, char *arg_vet[])
 {
- PackedIndex=0;
  SentPacketNumber=0;
  ReceiveNumber=0;
 
@@ -72,9 +234,6 @@ int sc_main(int arg_num, char *arg_vet[])
 	 */
 	//FaultRouter.push_back(2);
 //FaultRouter.push_back(3);
-FaultRouter.push_back(5);
-FaultRouter.push_back(10);
-FaultRouter.push_back(11);		
 //FaultRouter.push_back(7);
 //FaultRouter.push_back(8);
 //FaultRouter.push_back(9);
@@ -90,15 +249,138 @@ FaultRouter.push_back(11);
 
     parseCmdLine(arg_num, arg_vet);
 
+    // The trials of the saturation search all measure the same window,
+    // the steady state detection ends the run by itself, and the branches
+    // of a campaign need traffic left after their shared warm-up
+    packet_cap_lifted = NoximGlobalParams::saturation ||
+	NoximGlobalParams::steady_batch > 0 ||
+	NoximGlobalParams::campaign_branch;
+
+    // Built-in fault set, replaced by the events of the fault file or by
+    // the sets of a fault campaign
+    if (NoximGlobalParams::faults_filename[0] == '\0' &&
+	NoximGlobalParams::campaign == CAMPAIGN_OFF) {
+	FaultRouter.push_back(5);
+	FaultRouter.push_back(10);
+	FaultRouter.push_back(11);
+    }
+
+    // Engine verification: a child process runs the SystemC engine
+    // silently and sends back its digest, this one runs the native engine
+    pid_t verify_pid = -1;
+    int verify_fd = -1;
+
+    if (NoximGlobalParams::engine == ENGINE_VERIFY) {
+	int fds[2];
+
+	cout.flush();
+	if (pipe(fds) != 0 || (verify_pid = fork()) < 0) {
+	    cerr << "Error: cannot start the SystemC reference run" << endl;
+	    exit(1);
+	}
+
+	if (verify_pid == 0) {
+	    close(fds[0]);
+	    verify_fd = fds[1];
+	    int null_fd = open("/dev/null", O_WRONLY);
+	    dup2(null_fd, STDOUT_FILENO);
+	    NoximGlobalParams::engine = ENGINE_SYSTEMC;
+	} else {
+	    close(fds[1]);
+	    verify_fd = fds[0];
+	    NoximGlobalParams::engine = ENGINE_NATIVE;
+	}
+    }
+
+    // The SystemC reference run of a verification logs nothing
+    if (NoximGlobalParams::log_level != LOG_OFF && verify_pid != 0 &&
+	!EventLog.open(NoximGlobalParams::log_filename,
+		       NoximGlobalParams::log_level)) {
+	cerr << "Error: cannot create the event log " <<
+	    NoximGlobalParams::log_filename << endl;
+	exit(1);
+    }
+
+    if (NoximGlobalParams::packet_trace_filename[0] != '\0' && verify_pid != 0
+	&& !PacketTrace.open(NoximGlobalParams::packet_trace_filename,
+			     NoximGlobalParams::packet_trace_records)) {
+	cerr << "Error: cannot create the packet trace " <<
+	    NoximGlobalParams::packet_trace_filename << endl;
+	exit(1);
+    }
+
     // Signals
     sc_clock clock("clock", 1, SC_NS);
     sc_signal <bool> reset;
 
     // NoC instance
+    clock_t elaboration_start = ::clock();
     NoximNoC *n = new NoximNoC("NoC");
     n->clock(clock);
     n->reset(reset);
 
+    // The native engine takes over the wiring of the NoC
+    NoximNativeEngine *engine = NULL;
+    if (NoximGlobalParams::engine == ENGINE_NATIVE)
+	engine = new NoximNativeEngine(n, NoximGlobalParams::threads);
+
+    showMemoryReport(n, engine,
+		     (double) (::clock() - elaboration_start) / CLOCKS_PER_SEC);
+    if (engine && NoximGlobalParams::threads > 1)
+	cout << "Native engine running on " << engine->getThreads()
+	    << " threads" << endl;
+
+    // Cross-validate the compiled routing decisions before using them
+    if (NoximGlobalParams::routing_check) {
+	unsigned long states;
+	unsigned long mismatches = NegativeFirstTable.selfCheck(states);
+
+	if (mismatches > 0) {
+	    cerr << "Error: the routing table differs from the routing function in "
+		<< mismatches << " out of " << states << " states" << endl;
+	    exit(1);
+	}
+	cout << "Routing table checked on " << states << " states" << endl;
+    }
+
+    // The routes of every pair, walked on the elaborated NoC
+    if (NoximGlobalParams::reachability) {
+	NoximReachability reachability(n);
+	reachability.analyze(NoximGlobalParams::threads);
+	reachability.showReport(cout);
+	return 0;
+    }
+
+    // A fault campaign runs the elaborated NoC once per fault set
+    if (NoximGlobalParams::campaign != CAMPAIGN_OFF) {
+	NoximCampaign campaign(n, engine);
+	return campaign.run(cout) ? 0 : 1;
+    }
+
+    // So does the search of the saturation injection rate
+    if (NoximGlobalParams::saturation) {
+	NoximSaturationSearch search(n, engine);
+	return search.run(cout) ? 0 : 1;
+    }
+
+    // Batches of the steady state detection start with the simulation
+    if (NoximGlobalParams::steady_batch > 0)
+	n->convergence.configure(NoximGlobalParams::steady_batch,
+				 NoximGlobalParams::steady_tolerance,
+				 NoximGlobalParams::mesh_dim_x *
+				 NoximGlobalParams::mesh_dim_y,
+				 DEFAULT_RESET_TIME);
+
+    if (NoximGlobalParams::snapshot_filename[0] != '\0' && verify_pid != 0
+	&& !n->snapshots.open(NoximGlobalParams::snapshot_filename,
+			      NoximGlobalParams::snapshot_interval,
+			      NoximGlobalParams::mesh_dim_x *
+			      NoximGlobalParams::mesh_dim_y)) {
+	cerr << "Error: cannot create the snapshot file " <<
+	    NoximGlobalParams::snapshot_filename << endl;
+	exit(1);
+    }
+
     // Trace signals
     sc_trace_file *tf = NULL;
     if (NoximGlobalParams::trace_mode) {
@@ -130,25 +412,54 @@ FaultRouter.push_back(11);
 	    }
 	}
     }
-    // Reset the chip and run the simulation
+    // Reset the chip, or continue from a checkpoint, and run the simulation
+    int restored_cycles = 0;
     reset.write(1);
-    cout << "Reset...";
-    srand(NoximGlobalParams::rnd_generator_seed);	// time(NULL));
-    sc_start(DEFAULT_RESET_TIME, SC_NS);
+    if (NoximGlobalParams::restore_checkpoint_filename[0] != '\0') {
+	cout << "Restoring " << NoximGlobalParams::
+	    restore_checkpoint_filename << "...";
+	restored_cycles =
+	    restoreCheckpoint(n, engine,
+			      NoximGlobalParams::restore_checkpoint_filename);
+	cout << " done at cycle " << getCurrentCycle() << "!";
+    } else {
+	cout << "Reset...";
+	srand(NoximGlobalParams::rnd_generator_seed);	// time(NULL));
+	if (engine)
+	    engine->reset(DEFAULT_RESET_TIME);
+	else
+	    sc_start(DEFAULT_RESET_TIME, SC_NS);
+	cout << " done!";
+    }
     reset.write(0);
-    cout << " done! Now running for " << NoximGlobalParams::
+    cout << " Now running for " << NoximGlobalParams::
 	simulation_time << " cycles..." << endl;
 	for(std::vector< int >::iterator it = FaultRouter.begin(); it != FaultRouter.end(); ++it)
             {
 				cout<<"check"<<*it<<endl;}
-    sc_start(NoximGlobalParams::simulation_time, SC_NS);
+    if (engine)
+	engine->run(NoximGlobalParams::simulation_time);
+    else
+	sc_start(NoximGlobalParams::simulation_time, SC_NS);
+
+    // The statistics of a continued simulation cover the cycles before
+    // the checkpoint too
+    NoximGlobalParams::simulation_time += restored_cycles;
+
+    if (NoximGlobalParams::save_checkpoint_filename[0] != '\0') {
+	// A stop request on the rising edge leaves its cycle half evaluated
+	if (native_stop && getCurrentCycle() == floor(getCurrentCycle()))
+	    cerr << "Warning: the simulation stopped within a cycle, no checkpoint saved" << endl;
+	else
+	    saveCheckpoint(n, engine,
+			   NoximGlobalParams::save_checkpoint_filename);
+    }
 
     // Close the simulation
     if (NoximGlobalParams::trace_mode)
 	sc_close_vcd_trace_file(tf);
     cout << "Noxim simulation completed." << endl;
-    cout << " ( " << sc_time_stamp().to_double() /
-	1000 << " cycles executed)" << endl;
+    cout << " ( " << getCurrentCycle() << " cycles executed)" << endl;
     cout<<"Totel sent Packet Number"<<SentPacketNumber<<endl;
 
     // Show statistics
@@ -156,15 +467,29 @@ FaultRouter.push_back(11);
     cout << " Total received packets: " << ReceiveNumber<<endl;//getReceivedPackets() << endl;
     NoximGlobalStats gs(n);
     gs.showStats(std::cout, NoximGlobalParams::detailed);
-    int count=0;
-	for(int i=0;i<PacketState.size();i++){
-		 
-		if(PacketState[i]==STATE_NO_PATH) {count++;}
-		cout<<"########STATE"<<i<<":"<<PacketState[i]<<endl;
-		}
-    cout<<"FALSE COUNTER"<<count<<endl;
+    if (n->convergence.enabled())
+	n->convergence.showReport(cout);
+    if (NoximGlobalParams::delay_histogram_filename[0] != '\0' &&
+	verify_pid != 0) {
+	ofstream fout(NoximGlobalParams::delay_histogram_filename);
+
+	gs.showDelayHistograms(fout);
+	if (!fout) {
+	    cerr << "Error: cannot write the delay histograms to " <<
+		NoximGlobalParams::delay_histogram_filename << endl;
+	    exit(1);
+	}
+    }
+    if (EventLog.enabled(LOG_STATES))
+	for (unsigned int i = 0; i < PacketRegistry.size(); i++)
+	    EventLog.write(LOG_STATES, (unsigned int) getCurrentCycle(),
+			   EVENT_PACKET_STATE, i, PacketRegistry.getState(i));
+    EventLog.close();
+    PacketTrace.close();
+    n->snapshots.close();
+    cout<<"FALSE COUNTER"<<PacketRegistry.getCount(STATE_NO_PATH)<<endl;
     if ((NoximGlobalParams::max_volume_to_be_drained > 0) &&
-	(sc_time_stamp().to_double() / 1000 >=
+	(getCurrentCycle() >=
 	 NoximGlobalParams::simulation_time)) {
 	cout <<
 	    "\nWARNING! the number of flits specified with -volume option"
@@ -183,6 +508,44 @@ FaultRouter.push_back(11);
 #endif
     }
 
+    if (verify_fd >= 0) {
+	NoximStatsDigest digest;
+	gs.getDigest(digest);
+
+	if (verify_pid == 0) {
+	    // SystemC reference run: hand the digest to the native run
+	    cout.flush();
+	    bool sent = (write(verify_fd, &digest, sizeof(digest)) ==
+			 (ssize_t) sizeof(digest));
+	    close(verify_fd);
+	    return sent ? 0 : 1;
+	}
+
+	NoximStatsDigest reference;
+	size_t got = 0;
+	while (got < sizeof(reference)) {
+	    ssize_t r = read(verify_fd, (char *) &reference + got,
+			     sizeof(reference) - got);
+	    if (r <= 0)
+		break;
+	    got += r;
+	}
+	close(verify_fd);
+	waitpid(verify_pid, NULL, 0);
+
+	if (got < sizeof(reference)) {
+	    cerr << "Error: SystemC reference run did not complete" << endl;
+	    return 1;
+	}
+
+	cout << endl << "Engine verification (native vs systemc):" << endl;
+	if (!checkDigests(digest, reference)) {
+	    cout << "FAILED" << endl;
+	    return 1;
+	}
+	cout << "PASSED" << endl;
+    }
+
     return 0;
 }
 
@@ -12,8 +12,12 @@
 #define __NOXIMMAIN_H__
 
 #include <cassert>
+#include <climits>
+#include <pthread.h>
 #include <systemc.h>
+#include <map>
 #include <vector>
+#include "NoximEventLog.h"
 using namespace std;
 
 #define SET_SENT_PACKET_NUMBER  1000
@@ -39,6 +43,7 @@ using namespace std;
 #define STATE_NOT_SENT         1
 #define STATE_SUCCESS          2
 #define STATE_NO_PATH          3
+#define PACKET_STATES          4
 
 // Routing algorithms
 #define ROUTING_XY             0
@@ -70,6 +75,19 @@ using namespace std;
 #define TRAFFIC_BUTTERFLY      7
 #define INVALID_TRAFFIC       -1
 
+// Simulation engines
+#define ENGINE_SYSTEMC         0
+#define ENGINE_NATIVE          1
+#define ENGINE_VERIFY          2
+#define INVALID_ENGINE        -1
+
+// Fault campaigns
+#define CAMPAIGN_OFF           0
+#define CAMPAIGN_LIST          1
+#define CAMPAIGN_RANDOM        2
+#define CAMPAIGN_ALL           3
+#define INVALID_CAMPAIGN      -1
+
 // Verbosity levels
 #define VERBOSE_OFF            0
 #define VERBOSE_LOW            1
@@ -102,9 +120,33 @@ using namespace std;
 #define DEFAULT_LOW_POWER_LINK_STRATEGY                false
 #define DEFAULT_QOS                                      1.0
 #define DEFAULT_SHOW_BUFFER_STATS                      false
-
-// TODO by Fafa - this MUST be removed!!! Use only STL vectors instead!!!
-#define MAX_STATIC_DIM 32
+#define DEFAULT_ENGINE                        ENGINE_SYSTEMC
+#define DEFAULT_THREADS                                    1
+#define DEFAULT_FAST_FORWARD                            true
+#define DEFAULT_ROUTING_CHECK                          false
+#define DEFAULT_FAULTS_FILENAME                           ""
+#define DEFAULT_REACHABILITY                           false
+#define DEFAULT_CAMPAIGN                        CAMPAIGN_OFF
+#define DEFAULT_CAMPAIGN_FILENAME                         ""
+#define DEFAULT_CAMPAIGN_RUNS                              0
+#define DEFAULT_CAMPAIGN_FAULTS                            0
+#define DEFAULT_JOBS                                       1
+#define DEFAULT_CAMPAIGN_BRANCH                        false
+#define DEFAULT_LOG_LEVEL                            LOG_OFF
+#define DEFAULT_LOG_FILENAME                              ""
+#define DEFAULT_PACKET_TRACE_RECORDS                       0
+#define DEFAULT_PACKET_TRACE_FILENAME                     ""
+#define DEFAULT_DELAY_HISTOGRAM_FILENAME                  ""
+#define DEFAULT_SNAPSHOT_INTERVAL                          0
+#define DEFAULT_SNAPSHOT_FILENAME                         ""
+#define DEFAULT_SATURATION                             false
+#define DEFAULT_SATURATION_MIN_PIR                     0.001
+#define DEFAULT_SATURATION_MAX_PIR                       1.0
+#define DEFAULT_SATURATION_FACTOR                        3.0
+#define DEFAULT_STEADY_BATCH                               0
+#define DEFAULT_STEADY_TOLERANCE                        0.05
+#define DEFAULT_SAVE_CHECKPOINT_FILENAME                  ""
+#define DEFAULT_RESTORE_CHECKPOINT_FILENAME               ""
 
 typedef unsigned int uint;
 
@@ -136,6 +178,33 @@ struct NoximGlobalParams {
     static bool low_power_link_strategy;
     static double qos;
     static bool show_buffer_stats;
+    static int engine;
+    static int threads;
+    static bool fast_forward;
+    static bool routing_check;
+    static char faults_filename[128];
+    static bool reachability;
+    static int campaign;
+    static char campaign_filename[128];
+    static int campaign_runs;
+    static int campaign_faults;
+    static int jobs;
+    static bool campaign_branch;
+    static int log_level;
+    static char log_filename[128];
+    static int packet_trace_records;
+    static char packet_trace_filename[128];
+    static char delay_histogram_filename[128];
+    static int snapshot_interval;
+    static char snapshot_filename[128];
+    static bool saturation;
+    static float saturation_min_pir;
+    static float saturation_max_pir;
+    static float saturation_factor;
+    static int steady_batch;
+    static double steady_tolerance;
+    static char save_checkpoint_filename[128];
+    static char restore_checkpoint_filename[128];
 };
 
 // NoximCoord -- XY coordinates type of the Tile inside the Mesh
@@ -155,7 +224,7 @@ enum NoximFlitType {
 
 // NoximPayload -- Payload definition
 struct NoximPayload {
-    sc_uint<32> data;	// Bus for the data to be exchanged
+    unsigned int data;	// Bus for the data to be exchanged
 
     inline bool operator ==(const NoximPayload & payload) const {
 	return (payload.data == data);
@@ -221,28 +290,87 @@ struct NoximNoP_data {
     };
 };
 
-// NoximFlit -- Flit definition
+// NoximRandom -- pseudo-random stream (splitmix64). Every router and PE
+// draws from its own stream, so the numbers it gets do not depend on
+// the order in which the other blocks are evaluated.
+#define NOXIM_RAND_MAX 0x7fffffff
+
+struct NoximRandom {
+    unsigned long long state;
+
+    // Stream 'stream' of the simulation seeded with 'seed'
+    void seed(const int seed, const int stream) {
+	state = ((unsigned long long) (unsigned int) seed << 32) |
+	    (unsigned int) stream;
+	state = mix(state);
+    }
+
+    // Uniform integer in [0, NOXIM_RAND_MAX]
+    inline int next() {
+	state += 0x9E3779B97F4A7C15ULL;
+	return (int) (mix(state) >> 33);
+    }
+
+    // Skip the next 'n' numbers of the stream
+    inline void discard(const unsigned long n) {
+	state += 0x9E3779B97F4A7C15ULL * n;
+    }
+
+    static inline unsigned long long mix(unsigned long long z) {
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+    }
+};
+
+// NoximFlit -- Flit definition (24 bytes, trivially copyable). Only the
+// last hop is kept: the whole path goes to the packet trace
 struct NoximFlit {
-    int src_id;
-    int dst_id;
-    int flit_id;
-    NoximFlitType flit_type;	// The flit type (FLIT_TYPE_HEAD, FLIT_TYPE_BODY, FLIT_TYPE_TAIL)
-    int sequence_no;		// The sequence number of the flit inside the packet
-    NoximPayload payload;	// Optional payload
-    double timestamp;		// Unix timestamp at packet generation
-    int hop_no;			// Current number of hops from source to destination
+    int flit_id;		// Id of the packet the flit belongs to
+    unsigned short src_id;
+    unsigned short dst_id;
+    unsigned short sequence_no;	// The sequence number of the flit inside the packet
+    unsigned short hop_no;	// Current number of hops from source to destination
+    unsigned char flit_type;	// The flit type (FLIT_TYPE_HEAD, FLIT_TYPE_BODY, FLIT_TYPE_TAIL)
     bool use_low_voltage_path;
-    vector <int> FlitPath;
+    unsigned char last_hop;	// Output direction taken at the previous router
+    NoximPayload payload;	// Optional payload
+    unsigned int timestamp;	// Cycle of packet generation
+
+    // Records the output direction taken at the current router
+    inline void pushHop(const int direction) {
+	last_hop = direction;
+	if (hop_no < USHRT_MAX)
+	    hop_no++;
+    }
+
+    // Direction of the last hop (DIRECTION_LOCAL if still at the source)
+    inline int lastHop() const {
+	if (hop_no == 0)
+	    return DIRECTION_LOCAL;
+	return last_hop;
+    }
+
+    // Copies the path of the (already routed) head flit of the packet
+    inline void setPath(const NoximFlit & head) {
+	hop_no = head.hop_no;
+	last_hop = head.last_hop;
+    }
 
     inline bool operator ==(const NoximFlit & flit) const {
-	return (flit.src_id == src_id && flit.dst_id == dst_id
+	return (flit.flit_id == flit_id
+		&& flit.src_id == src_id && flit.dst_id == dst_id
 		&& flit.flit_type == flit_type
 		&& flit.sequence_no == sequence_no
 		&& flit.payload == payload && flit.timestamp == timestamp
-		&& flit.hop_no == hop_no
+		&& flit.hop_no == hop_no && flit.last_hop == last_hop
 		&& flit.use_low_voltage_path == use_low_voltage_path);
 }};
 
+// NoximFlitHandle -- slot of a flit in the flit arena, carried by links
+// and buffers in place of the flit itself
+typedef unsigned int NoximFlitHandle;
+
 // Output overloading
 
 inline ostream & operator <<(ostream & os, const NoximFlit & flit)
@@ -366,12 +494,44 @@ inline int coord2Id(const NoximCoord & coord)
     return id;
 }
 
+// Simulation time and stop request, whichever engine is running
+
+extern double native_time;
+extern bool native_stop;
+
+inline double getCurrentCycle()
+{
+    if (NoximGlobalParams::engine == ENGINE_SYSTEMC)
+	return sc_time_stamp().to_double() / 1000;
+
+    return native_time;
+}
+
+inline void stopSimulation()
+{
+    if (NoximGlobalParams::engine == ENGINE_SYSTEMC)
+	sc_stop();
+    else
+	native_stop = true;
+}
+
 extern vector < int > FaultRouter;
 extern int SentPacketNumber;
-extern int PackedIndex;
-extern vector < int > PacketState;
+
+// A simulation stops once SET_SENT_PACKET_NUMBER packets have been sent
+// and received, counted from packet_budget_start (a simulation restored
+// from a checkpoint gets a budget of its own), unless the packet cap is
+// lifted for a run that must last a fixed number of cycles
+extern int packet_budget_start;
+extern bool packet_cap_lifted;
+
+inline bool allPacketsSent()
+{
+    return !packet_cap_lifted &&
+	SentPacketNumber - packet_budget_start >= SET_SENT_PACKET_NUMBER;
+}
+
 //extern vector < int > PacketPath;
 //extern vector< vector < int > > Path;
 extern int ReceiveNumber;
-extern int j;
 #endif
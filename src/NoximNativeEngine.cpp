@@ -0,0 +1,531 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the native simulation engine
+ */
+
+#include <cmath>
+#include <sched.h>
+#include "NoximNativeEngine.h"
+
+// Links of a tile: one per router input (including the local one)
+// plus the one entering the PE
+#define LINKS_PER_TILE (DIRECTIONS + 2)
+
+// Rounds of busy waiting before a thread at the barrier yields the CPU
+#define BARRIER_SPINS 1000
+
+void NoximBarrier::wait()
+{
+    int current = __atomic_load_n(&generation, __ATOMIC_ACQUIRE);
+
+    if (__atomic_add_fetch(&count, 1, __ATOMIC_ACQ_REL) == threads) {
+	// Last one in: reset for the next use and release the others
+	__atomic_store_n(&count, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&generation, current + 1, __ATOMIC_RELEASE);
+    } else {
+	for (int spins = 0;
+	     __atomic_load_n(&generation, __ATOMIC_ACQUIRE) == current;
+	     spins++)
+	    if (spins >= BARRIER_SPINS)
+		sched_yield();
+    }
+}
+
+NoximNativeEngine::NoximNativeEngine(NoximNoC * _noc, const int threads)
+{
+    noc = _noc;
+    quit = false;
+    idle_cycles = 0;
+
+    // Same order as the tiles are created (and their processes
+    // registered) by NoximNoC::buildMesh()
+    for (int i = 0; i < NoximGlobalParams::mesh_dim_x; i++)
+	for (int j = 0; j < NoximGlobalParams::mesh_dim_y; j++)
+	    tiles.push_back(noc->t[i][j]);
+
+    bind();
+
+    if (threads > 1)
+	partition(threads);
+}
+
+NoximLink & NoximNativeEngine::inputLink(const int x, const int y,
+					 const int direction)
+{
+    int id = y * NoximGlobalParams::mesh_dim_x + x;
+
+    return links[id * LINKS_PER_TILE + direction];
+}
+
+NoximLink & NoximNativeEngine::peLink(const int x, const int y)
+{
+    return inputLink(x, y, DIRECTION_LOCAL + 1);
+}
+
+void NoximNativeEngine::bind()
+{
+    int dim_x = NoximGlobalParams::mesh_dim_x;
+    int dim_y = NoximGlobalParams::mesh_dim_y;
+    int border = 2 * (dim_x + dim_y);
+
+    // Pointers to the wires are handed out below: size the vector once
+    links.resize(dim_x * dim_y * LINKS_PER_TILE + border);
+    int next_border = dim_x * dim_y * LINKS_PER_TILE;
+
+    // Same values buildMesh() writes on the borderline signals
+    NoximNoP_data tmp_NoP;
+
+    tmp_NoP.sender_id = NOT_VALID;
+    for (int i = 0; i < DIRECTIONS; i++) {
+	tmp_NoP.channel_status_neighbor[i].free_slots = NOT_VALID;
+	tmp_NoP.channel_status_neighbor[i].available = false;
+    }
+
+    for (int x = 0; x < dim_x; x++) {
+	for (int y = 0; y < dim_y; y++) {
+	    NoximRouter *r = noc->t[x][y]->r;
+	    NoximProcessingElement *pe = noc->t[x][y]->pe;
+
+	    r->reset.attach(&reset_wire);
+	    pe->reset.attach(&reset_wire);
+
+	    for (int d = 0; d < DIRECTIONS + 1; d++) {
+		NoximLink & in = inputLink(x, y, d);
+
+		r->flit_rx[d].attach(&in.flit);
+		r->req_rx[d].attach(&in.req);
+		r->ack_rx[d].attach(&in.ack);
+		r->free_slots[d].attach(&in.free_slots);
+
+		// Output side: PE, neighbor input or a dangling border link
+		NoximLink *out;
+
+		if (d == DIRECTION_LOCAL)
+		    out = &peLink(x, y);
+		else {
+		    int nx = x, ny = y;
+
+		    switch (d) {
+		    case DIRECTION_NORTH:
+			ny--;
+			break;
+		    case DIRECTION_EAST:
+			nx++;
+			break;
+		    case DIRECTION_SOUTH:
+			ny++;
+			break;
+		    case DIRECTION_WEST:
+			nx--;
+			break;
+		    }
+
+		    if (nx < 0 || nx >= dim_x || ny < 0 || ny >= dim_y) {
+			// Nobody drives the borderline inputs
+			in.NoP_data.init(tmp_NoP);
+
+			out = &links[next_border++];
+			out->free_slots.init(NOT_VALID);
+		    } else
+			out = &inputLink(nx, ny, (d + 2) % DIRECTIONS);
+
+		    r->NoP_data_in[d].attach(&in.NoP_data);
+		    r->NoP_data_out[d].attach(&out->NoP_data);
+		}
+
+		r->flit_tx[d].attach(&out->flit);
+		r->req_tx[d].attach(&out->req);
+		r->ack_tx[d].attach(&out->ack);
+		r->free_slots_neighbor[d].attach(&out->free_slots);
+	    }
+
+	    // The PE free_slots_neighbor, like the one of the local
+	    // router output, is bound to a signal nobody writes
+	    NoximLink & pe_in = peLink(x, y);
+	    NoximLink & local = inputLink(x, y, DIRECTION_LOCAL);
+
+	    pe->flit_rx.attach(&pe_in.flit);
+	    pe->req_rx.attach(&pe_in.req);
+	    pe->ack_rx.attach(&pe_in.ack);
+	    pe->free_slots_neighbor.attach(&pe_in.free_slots);
+
+	    pe->flit_tx.attach(&local.flit);
+	    pe->req_tx.attach(&local.req);
+	    pe->ack_tx.attach(&local.ack);
+	}
+    }
+
+    assert(next_border == (int) links.size());
+    initial_links = links;
+}
+
+// Drive the wires behind the port from the queue of a partition
+template < class T > static void setQueue(NoximOut < T > &port,
+					  NoximWireQueue < T > &queue)
+{
+    port.getWire()->queue = &queue;
+}
+
+void NoximNativeEngine::partition(const int threads)
+{
+    int dim_x = NoximGlobalParams::mesh_dim_x;
+    int dim_y = NoximGlobalParams::mesh_dim_y;
+
+    // Grid of regions with the shortest boundary, using as many of the
+    // requested threads as the mesh allows
+    int regions_x = 1, regions_y = 1;
+
+    for (int n = threads; n > 1 && regions_x * regions_y == 1; n--) {
+	int best_cost = INT_MAX;
+
+	for (int rx = 1; rx <= n; rx++) {
+	    if (n % rx != 0 || rx > dim_x || n / rx > dim_y)
+		continue;
+
+	    int cost = (rx - 1) * dim_y + (n / rx - 1) * dim_x;
+	    if (cost < best_cost) {
+		best_cost = cost;
+		regions_x = rx;
+		regions_y = n / rx;
+	    }
+	}
+    }
+
+    if (regions_x * regions_y == 1)
+	return;
+
+    // Pointers to the queues are handed out below: size the vector once
+    partitions.resize(regions_x * regions_y);
+    barrier.setThreads(partitions.size());
+
+    for (int x = 0; x < dim_x; x++) {
+	for (int y = 0; y < dim_y; y++) {
+	    int px = x * regions_x / dim_x;
+	    int py = y * regions_y / dim_y;
+	    NoximPartition & p = partitions[py * regions_x + px];
+	    NoximRouter *r = noc->t[x][y]->r;
+	    NoximProcessingElement *pe = noc->t[x][y]->pe;
+
+	    p.engine = this;
+	    p.tiles.push_back(noc->t[x][y]);
+
+	    for (int d = 0; d < DIRECTIONS + 1; d++) {
+		setQueue(r->flit_tx[d], p.flit_wires);
+		setQueue(r->req_tx[d], p.bool_wires);
+		setQueue(r->ack_rx[d], p.bool_wires);
+		setQueue(r->free_slots[d], p.int_wires);
+		if (d != DIRECTION_LOCAL)
+		    setQueue(r->NoP_data_out[d], p.NoP_wires);
+	    }
+
+	    setQueue(pe->flit_tx, p.flit_wires);
+	    setQueue(pe->req_tx, p.bool_wires);
+	    setQueue(pe->ack_rx, p.bool_wires);
+	}
+    }
+}
+
+int NoximNativeEngine::getThreads() const
+{
+    return partitions.empty() ? 1 : partitions.size();
+}
+
+void NoximNativeEngine::evaluate()
+{
+    for (unsigned int i = 0; i < tiles.size(); i++) {
+	NoximTile *tile = tiles[i];
+
+	tile->r->rxProcess();
+	tile->r->txProcess();
+	tile->r->bufferMonitor();
+	tile->pe->rxProcess();
+	tile->pe->txProcess();
+    }
+}
+
+void NoximNativeEngine::commit()
+{
+    NoximWire < bool >::commitAll();
+    NoximWire < int >::commitAll();
+    NoximWire < NoximFlitHandle >::commitAll();
+    NoximWire < NoximNoP_data >::commitAll();
+
+    for (unsigned int i = 0; i < partitions.size(); i++)
+	commit(partitions[i]);
+}
+
+void NoximNativeEngine::evaluateRouters(NoximPartition & p)
+{
+    for (unsigned int i = 0; i < p.tiles.size(); i++) {
+	NoximRouter *r = p.tiles[i]->r;
+
+	r->rxProcess();
+	r->txProcess();
+	r->bufferMonitor();
+    }
+}
+
+void NoximNativeEngine::evaluateProcessingElements()
+{
+    // Tile order, as in evaluate(): each router's updates to the packet
+    // bookkeeping come right before the processes of its PE
+    for (unsigned int i = 0; i < tiles.size(); i++) {
+	NoximTile *tile = tiles[i];
+
+	tile->r->commitDeferred();
+	tile->pe->rxProcess();
+	tile->pe->txProcess();
+    }
+}
+
+void NoximNativeEngine::commit(NoximPartition & p)
+{
+    p.bool_wires.commit();
+    p.int_wires.commit();
+    p.flit_wires.commit();
+    p.NoP_wires.commit();
+}
+
+void *NoximNativeEngine::worker(void *arg)
+{
+    NoximPartition & p = *(NoximPartition *) arg;
+    NoximNativeEngine *engine = p.engine;
+
+    for (;;) {
+	engine->barrier.wait();
+	if (engine->quit)
+	    break;
+
+	engine->evaluateRouters(p);
+	engine->barrier.wait();
+	// PEs and bookkeeping are handled by the main thread
+	engine->barrier.wait();
+	engine->commit(p);
+    }
+
+    return NULL;
+}
+
+int NoximNativeEngine::fastForward(const int max_cycles)
+{
+    if (!NoximGlobalParams::fast_forward)
+	return 0;
+
+    // Under reset nothing moves and the PEs make no draw: once the
+    // reset values have settled only the leakage is left to account
+    if (reset_wire.cur) {
+	if (++idle_cycles < 2)
+	    return 0;
+
+	int cycles = noc->faultIdleCycles(max_cycles);
+	cycles = noc->snapshotIdleCycles(cycles);
+	cycles = noc->convergenceIdleCycles(cycles);
+
+	if (cycles <= 0)
+	    return 0;
+
+	for (unsigned int i = 0; i < tiles.size(); i++)
+	    tiles[i]->r->skipResetCycles(cycles);
+	native_time += cycles;
+
+	return cycles;
+    }
+
+    for (unsigned int i = 0; i < tiles.size(); i++)
+	if (!tiles[i]->r->isIdle() || !tiles[i]->pe->isIdle()) {
+	    idle_cycles = 0;
+	    return 0;
+	}
+
+    // After two quiet cycles no handshake is pending and the wires
+    // carrying the buffer levels have settled
+    if (++idle_cycles < 2)
+	return 0;
+
+    int cycles = max_cycles;
+
+    for (unsigned int i = 0; i < tiles.size() && cycles > 0; i++)
+	cycles = tiles[i]->pe->idleCycles(cycles);
+
+    cycles = noc->faultIdleCycles(cycles);
+    cycles = noc->snapshotIdleCycles(cycles);
+    cycles = noc->convergenceIdleCycles(cycles);
+
+    if (cycles <= 0)
+	return 0;
+
+    for (unsigned int i = 0; i < tiles.size(); i++) {
+	tiles[i]->r->skipIdleCycles(cycles);
+	tiles[i]->pe->skipIdleCycles(cycles);
+    }
+    native_time += cycles;
+
+    return cycles;
+}
+
+void NoximNativeEngine::simulateParallel(const int cycles)
+{
+    for (unsigned int i = 0; i < tiles.size(); i++)
+	tiles[i]->r->setDeferGlobals(true);
+
+    // The calling thread simulates the first partition
+    quit = false;
+    for (unsigned int i = 1; i < partitions.size(); i++)
+	if (pthread_create(&partitions[i].thread, NULL, worker,
+			   &partitions[i]) != 0) {
+	    cerr << "Error: cannot create the simulation threads" << endl;
+	    exit(1);
+	}
+
+    for (int c = 0; c < cycles; c++) {
+	// Rising edge
+	barrier.wait();
+	evaluateRouters(partitions[0]);
+	barrier.wait();
+	evaluateProcessingElements();
+	barrier.wait();
+	commit(partitions[0]);
+
+	if (native_stop)
+	    break;
+
+	// Falling edge, while the other partitions complete the commit
+	native_time += 0.5;
+	noc->CheckPacketState();
+	noc->faultProcess();
+	noc->snapshotProcess();
+	noc->convergenceProcess();
+
+	if (native_stop)
+	    break;
+
+	native_time += 0.5;
+	c += fastForward(cycles - c - 1);
+    }
+
+    quit = true;
+    barrier.wait();
+    for (unsigned int i = 1; i < partitions.size(); i++)
+	pthread_join(partitions[i].thread, NULL);
+
+    for (unsigned int i = 0; i < tiles.size(); i++)
+	tiles[i]->r->setDeferGlobals(false);
+}
+
+void NoximNativeEngine::simulate(const int cycles)
+{
+    if (!partitions.empty()) {
+	simulateParallel(cycles);
+	return;
+    }
+
+    for (int c = 0; c < cycles; c++) {
+	// Rising edge: every router and PE process
+	evaluate();
+	commit();
+
+	// A stop request lets the current evaluation complete, like
+	// sc_stop() lets the current delta cycle complete
+	if (native_stop)
+	    return;
+
+	// Falling edge
+	native_time += 0.5;
+	noc->CheckPacketState();
+	noc->faultProcess();
+	noc->snapshotProcess();
+	noc->convergenceProcess();
+
+	if (native_stop)
+	    return;
+
+	native_time += 0.5;
+	c += fastForward(cycles - c - 1);
+    }
+}
+
+void NoximNativeEngine::reset(const int cycles)
+{
+    native_time = 0.0;
+    native_stop = false;
+    idle_cycles = 0;
+    reset_wire.init(true);
+
+    for (unsigned int i = 0; i < links.size(); i++) {
+	links[i].req.init(initial_links[i].req.cur);
+	links[i].flit.init(initial_links[i].flit.cur);
+	links[i].ack.init(initial_links[i].ack.cur);
+	links[i].free_slots.init(initial_links[i].free_slots.cur);
+	links[i].NoP_data.init(initial_links[i].NoP_data.cur);
+    }
+
+    // Initialization phase: every process runs once at time zero
+    evaluate();
+    commit();
+    noc->CheckPacketState();
+    noc->faultProcess();
+    noc->snapshotProcess();
+    noc->convergenceProcess();
+
+    simulate(cycles);
+}
+
+void NoximNativeEngine::run(const int cycles)
+{
+    // Deasserted reset is seen together with the first rising edge
+    reset_wire.init(false);
+    idle_cycles = 0;
+
+    simulate(cycles);
+}
+
+void NoximNativeEngine::checkpoint(NoximCheckpoint & cp)
+{
+    // Between two cycles every wire is committed: only the values seen
+    // by the readers are kept
+    for (unsigned int i = 0; i < links.size(); i++) {
+	cp.transfer(links[i].req.cur);
+	cp.transfer(links[i].flit.cur);
+	cp.transfer(links[i].ack.cur);
+	cp.transfer(links[i].free_slots.cur);
+	cp.transfer(links[i].NoP_data.cur);
+
+	if (cp.isRestoring()) {
+	    links[i].req.init(links[i].req.cur);
+	    links[i].flit.init(links[i].flit.cur);
+	    links[i].ack.init(links[i].ack.cur);
+	    links[i].free_slots.init(links[i].free_slots.cur);
+	    links[i].NoP_data.init(links[i].NoP_data.cur);
+	}
+    }
+
+    if (cp.isRestoring()) {
+	native_time = cp.getHeader().cycle;
+	native_stop = false;
+	idle_cycles = 0;
+	reset_wire.init(false);
+    }
+}
+
+void NoximNativeEngine::resume()
+{
+    if (native_time == floor(native_time))
+	return;
+
+    // CheckPacketState() stopped the simulation before these
+    noc->faultProcess();
+    noc->snapshotProcess();
+    noc->convergenceProcess();
+    native_time += 0.5;
+}
+
+size_t NoximNativeEngine::getMemory() const
+{
+    return (links.capacity() + initial_links.capacity()) * sizeof(NoximLink) +
+	tiles.capacity() * sizeof(NoximTile *);
+}
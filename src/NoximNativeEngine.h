@@ -0,0 +1,139 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the native simulation engine
+ */
+
+#ifndef __NOXIMNATIVEENGINE_H__
+#define __NOXIMNATIVEENGINE_H__
+
+#include <vector>
+#include <pthread.h>
+#include "NoximMain.h"
+#include "NoximPort.h"
+#include "NoximNoC.h"
+using namespace std;
+
+// NoximLink -- wires of the channel entering an input port. req, flit
+// and NoP data are driven by the sender, ack and free_slots by the
+// receiver.
+struct NoximLink {
+    NoximWire < bool > req;
+    NoximWire < NoximFlitHandle > flit;
+    NoximWire < bool > ack;
+    NoximWire < int > free_slots;
+    NoximWire < NoximNoP_data > NoP_data;
+};
+
+class NoximNativeEngine;
+
+// NoximPartition -- rectangular region of the mesh simulated by one
+// thread, with the queues of the wires its tiles drive
+struct NoximPartition {
+    vector < NoximTile * >tiles;
+    NoximWireQueue < bool > bool_wires;
+    NoximWireQueue < int > int_wires;
+    NoximWireQueue < NoximFlitHandle > flit_wires;
+    NoximWireQueue < NoximNoP_data > NoP_wires;
+
+    NoximNativeEngine *engine;
+    pthread_t thread;
+};
+
+// NoximBarrier -- spinning barrier among the threads of the native engine
+class NoximBarrier {
+  public:
+    NoximBarrier():count(0), generation(0), threads(1) {
+    }
+
+    void setThreads(const int _threads) {
+	threads = _threads;
+    }
+
+    void wait();
+
+  private:
+    int count;			// Threads arrived at the barrier
+    int generation;		// Times the barrier has been passed
+    int threads;
+};
+
+// NoximNativeEngine -- steps the router and PE processes of an already
+// built NoC in a plain evaluate/commit loop, without the SystemC
+// scheduler. Processes are evaluated in the same order as the SystemC
+// kernel runs them, so that the packet bookkeeping evolves identically
+// in both engines.
+//
+// With more than one thread the mesh is split into rectangular
+// partitions. Each cycle the routers of all partitions are evaluated in
+// parallel, keeping aside their updates to the global bookkeeping; then
+// one thread applies those updates and runs the PEs in tile order, and
+// finally each partition commits the wires it drives.
+//
+// Once nothing has moved in the whole mesh for two cycles, the engine
+// jumps straight to the next cycle at which a PE injects a packet, or a
+// fault event, a metrics snapshot or a steady state batch is due,
+// accounting the skipped cycles without evaluating them. The reset phase
+// is skipped the same way once settled.
+class NoximNativeEngine {
+
+  public:
+
+    NoximNativeEngine(NoximNoC * _noc, const int threads);
+
+    // Initialization phase plus 'cycles' clock cycles with reset asserted.
+    // The links start again from their values at elaboration, so that an
+    // already simulated NoC can be run again after NoximNoC::restart()
+    void reset(const int cycles);
+
+    // 'cycles' clock cycles with reset deasserted (or until a stop request)
+    void run(const int cycles);
+
+    // Saves the values on the links and the time, or restores them in
+    // place of reset(): run() then continues from the checkpoint
+    void checkpoint(NoximCheckpoint & cp);
+
+    // Completes the falling edge of a checkpoint taken when the packets
+    // ran out, once the whole state has been restored
+    void resume();
+
+    // Bytes allocated for the links
+    size_t getMemory() const;
+
+    // Number of threads actually used
+    int getThreads() const;
+
+  private:
+
+    NoximNoC *noc;
+    vector < NoximTile * >tiles;	// Tiles in SystemC process order
+    vector < NoximLink > links;	// Router inputs, PE input, then mesh border
+    vector < NoximLink > initial_links;	// Values of the links at elaboration
+    NoximWire < bool > reset_wire;
+
+    vector < NoximPartition > partitions;	// Empty when single-threaded
+    NoximBarrier barrier;
+    bool quit;			// Tells the workers to terminate
+    int idle_cycles;		// Consecutive cycles with nothing moving
+
+    NoximLink & inputLink(const int x, const int y, const int direction);
+    NoximLink & peLink(const int x, const int y);
+    void bind();
+    void partition(const int threads);
+    void evaluate();
+    void commit();
+    void simulate(const int cycles);
+    int fastForward(const int max_cycles);
+
+    void evaluateRouters(NoximPartition & p);
+    void evaluateProcessingElements();
+    void commit(NoximPartition & p);
+    void simulateParallel(const int cycles);
+    static void *worker(void *arg);
+};
+
+#endif
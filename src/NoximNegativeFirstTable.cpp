@@ -0,0 +1,580 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the compiled decision table
+ * of the negative-first fault tolerant routing
+ */
+
+#include "NoximNegativeFirstTable.h"
+
+// Shortest and longest distance found for a class of one axis, with the
+// coordinates giving them
+struct NoximAxisSample {
+    bool found;
+    int min_distance, min_from, min_to;
+    int max_distance, max_from, max_to;
+
+    void add(const int from, const int to) {
+	int distance = abs(to - from);
+
+	if (!found || distance < min_distance) {
+	    min_distance = distance;
+	    min_from = from;
+	    min_to = to;
+	}
+	if (!found || distance > max_distance) {
+	    max_distance = distance;
+	    max_from = from;
+	    max_to = to;
+	}
+	found = true;
+    }
+};
+
+NoximNegativeFirstTable::NoximNegativeFirstTable()
+{
+    dim_x = dim_y = 0;
+}
+
+int NoximNegativeFirstTable::axisClass(const int distance,
+				       const bool current_flag,
+				       const bool destination_low,
+				       const bool destination_high)
+{
+    int sign = (distance > 0) - (distance < 0) + 1;
+
+    return sign * 16 + (abs(distance) == 1) * 8 + current_flag * 4 +
+	destination_low * 2 + destination_high;
+}
+
+bool NoximNegativeFirstTable::isNeighbor(const NoximCoord & current,
+					 const int direction,
+					 const NoximCoord & destination)
+{
+    NoximCoord neighbor = current;
+
+    switch (direction) {
+    case DIRECTION_NORTH:
+	neighbor.y--;
+	break;
+    case DIRECTION_SOUTH:
+	neighbor.y++;
+	break;
+    case DIRECTION_EAST:
+	neighbor.x++;
+	break;
+    case DIRECTION_WEST:
+	neighbor.x--;
+	break;
+    }
+
+    return neighbor == destination;
+}
+
+void NoximNegativeFirstTable::compile()
+{
+    dim_x = NoximGlobalParams::mesh_dim_x;
+    dim_y = NoximGlobalParams::mesh_dim_y;
+
+    // The routing looks at current.x == 0 and current.y == dim_y - 1,
+    // and at the destination lying on any border
+    vector < NoximAxisSample > x_samples(NFT_AXIS_CLASSES);
+    vector < NoximAxisSample > y_samples(NFT_AXIS_CLASSES);
+
+    for (int i = 0; i < NFT_AXIS_CLASSES; i++)
+	x_samples[i].found = y_samples[i].found = false;
+
+    x_class.resize(dim_x * dim_x);
+    for (int from = 0; from < dim_x; from++)
+	for (int to = 0; to < dim_x; to++) {
+	    int c = axisClass(to - from, from == 0, to == 0, to == dim_x - 1);
+	    x_class[from * dim_x + to] = c;
+	    x_samples[c].add(from, to);
+	}
+
+    y_class.resize(dim_y * dim_y);
+    for (int from = 0; from < dim_y; from++)
+	for (int to = 0; to < dim_y; to++) {
+	    int c = axisClass(to - from, from == dim_y - 1, to == 0,
+			      to == dim_y - 1);
+	    y_class[from * dim_y + to] = c;
+	    y_samples[c].add(from, to);
+	}
+
+    // One representative pair for every class found in the mesh: the
+    // longest distance along one axis against the shortest along the
+    // other tells whether either comparison of the two can occur
+    table.assign(NFT_AXIS_CLASSES * NFT_AXIS_CLASSES * 2 * NFT_LAST_HOPS *
+		 NFT_FAULT_MASKS, NFT_UNKNOWN);
+
+    for (int xc = 0; xc < NFT_AXIS_CLASSES; xc++) {
+	const NoximAxisSample & xs = x_samples[xc];
+	if (!xs.found)
+	    continue;
+
+	for (int yc = 0; yc < NFT_AXIS_CLASSES; yc++) {
+	    const NoximAxisSample & ys = y_samples[yc];
+	    if (!ys.found)
+		continue;
+
+	    for (int x_longer = 0; x_longer < 2; x_longer++) {
+		NoximCoord current, destination;
+
+		if (x_longer) {
+		    if (xs.max_distance < ys.min_distance)
+			continue;
+		    current.x = xs.max_from;
+		    destination.x = xs.max_to;
+		    current.y = ys.min_from;
+		    destination.y = ys.min_to;
+		} else {
+		    if (xs.min_distance >= ys.max_distance)
+			continue;
+		    current.x = xs.min_from;
+		    destination.x = xs.min_to;
+		    current.y = ys.max_from;
+		    destination.y = ys.max_to;
+		}
+
+		int geometry = (xc * NFT_AXIS_CLASSES + yc) * 2 + x_longer;
+
+		for (int last_hop = 0; last_hop < NFT_LAST_HOPS; last_hop++)
+		    for (int fault = 0; fault < NFT_FAULT_MASKS; fault++) {
+			int no_path;
+			int direction = reference(current, destination,
+						  last_hop, fault, no_path);
+
+			assert(no_path < NFT_NO_PATH);
+			assert(no_path == 0 || direction == DIRECTION_LOCAL);
+
+			table[(geometry * NFT_LAST_HOPS + last_hop) *
+			      NFT_FAULT_MASKS + fault] =
+			    no_path ? NFT_NO_PATH | no_path : direction;
+		    }
+	    }
+	}
+    }
+}
+
+unsigned long NoximNegativeFirstTable::selfCheck(unsigned long &states) const
+{
+    unsigned long mismatches = 0;
+
+    states = 0;
+    for (int id = 0; id < dim_x * dim_y; id++) {
+	NoximCoord current = id2Coord(id);
+
+	for (int dst = 0; dst < dim_x * dim_y; dst++) {
+	    NoximCoord destination = id2Coord(dst);
+
+	    for (int last_hop = 0; last_hop < NFT_LAST_HOPS; last_hop++)
+		for (int fault = 0; fault < NFT_FAULT_MASKS; fault++) {
+		    int no_path;
+		    int direction = reference(current, destination,
+					      last_hop, fault, no_path);
+		    int entry = no_path ? NFT_NO_PATH | no_path : direction;
+
+		    if (lookup(current, destination, last_hop, fault) != entry)
+			mismatches++;
+		    states++;
+		}
+	}
+    }
+
+    return mismatches;
+}
+
+size_t NoximNegativeFirstTable::getMemory() const
+{
+    return table.capacity() + x_class.capacity() + y_class.capacity();
+}
+
+int NoximNegativeFirstTable::reference(const NoximCoord & current,
+				       const NoximCoord & destination,
+				       const int last_hop, const int fault,
+				       int &no_path)
+{
+	
+	int direction = NOT_VALID;
+	no_path = 0;
+
+	int Fault= fault;
+	//for (int i=0;i<flit.FlitPath[flit.FlitPath.size()];i++){cout<<"Path"<<i<<"is"<<flit.FlitPath[i]<<endl;}
+	//cout<<"Path"<<flit.FlitPath<<endl;
+	//cout<<"fault condition"<<Fault<<endl;
+	//cout<<"id"<<local_id<<endl;
+	//cout<<"destination"<<coord2Id(destination)<<endl;
+	if(destination.x > current.x && destination.y < current.y)  // if des in NE direction
+	{
+		//cout<<"NE"<<endl;
+		Fault=(Fault>>2);
+		if(Fault==3)
+		{
+		  if(last_hop==DIRECTION_WEST) {direction=DIRECTION_NORTH;}
+		  else if(last_hop==DIRECTION_SOUTH) {direction=DIRECTION_EAST;}
+          else {
+			  if(abs(destination.x - current.x) >= abs (destination.y - current.y)){direction=DIRECTION_EAST;}
+			  else{direction=DIRECTION_NORTH;}
+		  }   
+		}
+		else if(Fault==2)
+		{
+		  //if(last_hop==DIRECTION_WEST){direction=DIRECTION_LOCAL;NoPath=true;  cout<<"NoPath------------2"<<endl;}
+		   {direction=DIRECTION_EAST;}
+		}
+		else if(Fault==1)
+		{
+		  //if(last_hop==DIRECTION_SOUTH){direction=DIRECTION_LOCAL;NoPath=true;  cout<<"NoPath------------3"<<endl;}
+		   {direction=DIRECTION_NORTH;}
+		}
+		else {direction=DIRECTION_LOCAL;no_path=4;}	
+	}
+	else if(destination.x < current.x && destination.y < current.y)  // if des in NW direction
+	{
+		//cout<<"NW"<<endl;
+		if(current.x-destination.x==1)
+		{
+		   if(last_hop==DIRECTION_EAST)
+		   {
+			if((Fault&4)==4){direction=DIRECTION_NORTH;}
+			else{direction=DIRECTION_LOCAL;no_path=5;}
+		   }
+		   else if(last_hop==DIRECTION_NORTH)
+		   {
+			int temp=Fault;
+			if((Fault&2)==2){direction=DIRECTION_WEST;}
+			else if((temp&4)==4){direction=DIRECTION_NORTH;}
+			else{direction=DIRECTION_LOCAL;no_path=6;}
+		   }
+		   else
+		   {
+			   int temp1=Fault;
+			   int temp2=Fault;
+			if((Fault&2)==2){direction=DIRECTION_WEST;}
+			else{
+				if((temp2&1)==1){direction=DIRECTION_SOUTH;}
+				else{
+				if(current.y==NoximGlobalParams::mesh_dim_y-1){
+					if((temp1&4)==4){direction=DIRECTION_NORTH;}
+					else{direction=DIRECTION_LOCAL;no_path=60;}
+				}
+			    else{direction=DIRECTION_LOCAL;no_path=7;}
+				}	
+	           }
+		   }   
+		}
+		
+		else if(current.y-destination.y==1)
+		{
+		   if(last_hop==DIRECTION_SOUTH)
+		   {
+			   int temp3=Fault;
+			if((Fault&2)==2){direction=DIRECTION_WEST;}
+			else{
+				if((temp3&1)==1){direction=DIRECTION_SOUTH;}
+				else{direction=DIRECTION_LOCAL;no_path=8;}
+			    }
+		   }
+		   else
+		   {
+			   int temp1=Fault;
+			   int temp2=Fault;
+			if((Fault&2)==2){direction=DIRECTION_WEST;}
+			else{
+				if((temp2&1)==1){direction=DIRECTION_SOUTH;}
+				else{
+				if(current.y==NoximGlobalParams::mesh_dim_y-1){
+					if((temp1&4)==4){direction=DIRECTION_NORTH;}
+					else{direction=DIRECTION_LOCAL;no_path=61;}
+				}
+			    else{direction=DIRECTION_LOCAL;no_path=10;}
+				}	
+	           }
+		   }   
+		}
+		else
+		{
+			int temp=Fault;
+			int temp2=Fault;
+		  if((Fault&2)==0)
+		  {
+		    //if(last_hop==DIRECTION_WEST){direction=DIRECTION_LOCAL;NoPath=true;  cout<<"NoPath------------18"<<endl;}
+			if((temp&1)==0)
+			{
+				if(current.y==NoximGlobalParams::mesh_dim_y-1){
+					if((temp2&4)==4){direction=DIRECTION_NORTH;}
+					else{direction=DIRECTION_LOCAL;no_path=64;}
+				}
+				else{direction=DIRECTION_LOCAL;no_path=65;}
+			}
+		    else{direction=DIRECTION_SOUTH;}
+		  }
+		  else {direction=DIRECTION_WEST;}
+		}
+		
+	}
+	else if(destination.x > current.x && destination.y > current.y) // if des in SE direction
+	{
+		//cout<<"SE"<<endl;
+		if(destination.x - current.x==1)
+		{
+		   if(last_hop==DIRECTION_WEST)
+		   {
+			   int temp3=Fault;
+			if((Fault&1)==1){direction=DIRECTION_SOUTH;}
+			else{
+				if((temp3&2)==2){direction=DIRECTION_WEST;}
+				else{
+				direction=DIRECTION_LOCAL;no_path=12;}
+			    }
+		    }
+		   else
+		   {
+			   int temp1=Fault;
+			   int temp2=Fault;
+			if((Fault&1)==1){direction=DIRECTION_SOUTH;}
+			else{ 
+			if((temp2&2)==2){direction=DIRECTION_WEST;}
+			else{
+				if(current.x==0){
+					if((temp1&8)==8){direction=DIRECTION_EAST;}
+					else{direction=DIRECTION_LOCAL;no_path=52;}
+				}
+				else{direction=DIRECTION_LOCAL;no_path=53;}
+			}
+		   }
+		}
+		}
+		
+		else if(destination.y - current.y==1)
+		{
+		   if(last_hop==DIRECTION_NORTH)
+		   {
+			if((Fault&8)==8){direction=DIRECTION_EAST;}
+			else{direction=DIRECTION_LOCAL;no_path=15;}
+		   }
+		   else if(last_hop==DIRECTION_EAST)
+		   {
+			int temp=Fault;
+			if((Fault&1)==1){direction=DIRECTION_SOUTH;}
+			else if((temp&8)==8){direction=DIRECTION_EAST;}
+			else{direction=DIRECTION_LOCAL;no_path=16;}
+		   }
+		   else
+		   {	int temp1=Fault;
+			   int temp2=Fault;
+			if((Fault&1)==1){direction=DIRECTION_SOUTH;}
+            else{
+				
+			if((temp2&2)==2){direction=DIRECTION_WEST;}
+			else{
+				if(current.x==0){
+					if((temp1&8)==8){direction=DIRECTION_EAST;}
+					else{direction=DIRECTION_LOCAL;no_path=54;}
+				}
+				else{direction=DIRECTION_LOCAL;no_path=55;}
+			}
+		   }
+		   }   
+		}
+
+		else
+		{
+			int temp=Fault;
+			int temp2=Fault;
+		  if((Fault&1)==0)
+		  {
+		    //if(last_hop==DIRECTION_WEST){direction=DIRECTION_LOCAL;NoPath=true;  cout<<"NoPath------------18"<<endl;}
+			if((temp&2)==0)
+			{
+				if(current.x==0){
+					if((temp2&8)==8){direction=DIRECTION_EAST;}
+					else{direction=DIRECTION_LOCAL;no_path=50;}
+				}
+				else{direction=DIRECTION_LOCAL;no_path=51;}
+			}
+		    else{direction=DIRECTION_WEST;}
+		  }
+		  else {direction=DIRECTION_SOUTH;}
+		}
+	}
+	else if(destination.x < current.x && destination.y > current.y)  // if des in SW direction
+	{
+		//cout<<"SW"<<endl;
+		Fault=(Fault&3);
+		if(Fault==3)
+		{
+		  if(last_hop==DIRECTION_EAST) {direction=DIRECTION_SOUTH;}
+		  else if(last_hop==DIRECTION_NORTH) {direction=DIRECTION_WEST;}
+          else {
+					  if(abs(destination.x - current.x) >= abs (destination.y - current.y)) {direction=DIRECTION_WEST; }
+				    else {direction=DIRECTION_SOUTH;}
+					  
+					  
+		      }
+		}
+		else if(Fault==2)
+		{
+		  if(last_hop==DIRECTION_EAST){direction=DIRECTION_LOCAL;no_path=20;}
+		  else {direction=DIRECTION_WEST;}
+		}
+		else if(Fault==1)
+		{
+		  if(last_hop==DIRECTION_NORTH){direction=DIRECTION_LOCAL;no_path=21;}
+		  else {direction=DIRECTION_SOUTH;}
+		}
+		else {direction=DIRECTION_LOCAL;no_path=22;}	
+	}
+	
+	else if(destination.x == current.x && destination.y < current.y)  // if des in N direction
+	{
+		//cout<<"N"<<endl;
+	   int temp = Fault;
+	   int temp2=Fault;
+	   int temp3=Fault;
+	   int temp4=Fault;
+	   if(isNeighbor(current, DIRECTION_NORTH, destination)&&(temp3&4)==4){direction=DIRECTION_NORTH;}
+	   else if((temp2&2)==2){
+		   if((last_hop!=DIRECTION_EAST)&&(last_hop!=DIRECTION_NORTH))
+		   {direction=DIRECTION_WEST;}
+		   else if((temp4&4)==4)
+           {
+		      direction=DIRECTION_NORTH;
+           }
+		   else {direction=DIRECTION_LOCAL;no_path=70;}
+		   }
+	   else if((temp&4)==4)
+           {
+		      direction=DIRECTION_NORTH;
+           }
+	   else if(destination.x==0)
+		{
+		   if((Fault&8)==8){direction=DIRECTION_EAST;}
+		   else{direction=DIRECTION_LOCAL;no_path=24;}
+		}
+	   else	if(destination.x==NoximGlobalParams::mesh_dim_x-1)
+		{
+		   if((Fault&2)==2){direction=DIRECTION_WEST;}
+		   else{direction=DIRECTION_LOCAL;no_path=23;}
+		}
+		else{direction=DIRECTION_LOCAL;no_path=25;}
+        
+		  
+		
+		 	
+	}
+
+	else if(destination.x == current.x && destination.y > current.y)  // if des in S direction
+	{
+		//cout<<"S"<<endl;
+	   int temp = Fault;
+	   int temp2=Fault;
+	   int temp3=Fault;
+	  // int temp4=Fault;
+	   if(isNeighbor(current, DIRECTION_SOUTH, destination)&&(temp3&1)==1){direction=DIRECTION_SOUTH;}
+	   //else if((temp2&2)==2){direction=DIRECTION_WEST;}
+	   
+	   else if((temp&1)==1)
+           {
+		direction=DIRECTION_SOUTH;
+           }
+		else if((temp2&2)==2){direction=DIRECTION_WEST;}
+		else if(destination.x==0)
+		{
+		   if((Fault&8)==8){direction=DIRECTION_EAST;}
+		   else{direction=DIRECTION_LOCAL;no_path=45;}
+		}
+	   else if(destination.x==NoximGlobalParams::mesh_dim_x-1)
+		{
+		   if((Fault&2)==2){direction=DIRECTION_WEST;}
+		   else{direction=DIRECTION_LOCAL;no_path=44;}
+		}
+		
+		else{direction=DIRECTION_LOCAL;no_path=46;}
+           
+	    
+	  
+		   
+	     	
+	}
+
+	else if(destination.x > current.x && destination.y == current.y)  // if des in E direction
+	{
+		//cout<<"E"<<endl;
+	   int temp = Fault;
+	   int temp2=Fault;
+	   int temp3=Fault;
+	   int temp4=Fault;
+	   if(isNeighbor(current, DIRECTION_EAST, destination)&&(temp3&8)==8){direction=DIRECTION_EAST;}
+	   else if((temp2&1)==1){
+		   if((last_hop!=DIRECTION_EAST)&&(last_hop!=DIRECTION_NORTH))
+		   {direction=DIRECTION_SOUTH;}
+		   else if((temp4&8)==8)
+            {
+		     direction=DIRECTION_EAST;
+            }
+			else{direction=DIRECTION_LOCAL;no_path=71;}
+		   }
+	    else if((temp&8)==8)
+            {
+		     direction=DIRECTION_EAST;
+            }
+	         else if(destination.y==NoximGlobalParams::mesh_dim_y-1)
+		       {
+		         if((Fault&4)==4){direction=DIRECTION_NORTH;}
+		         else{direction=DIRECTION_LOCAL;no_path=29;}
+		       }
+		      else if(destination.y==0)
+		      {
+		         if((Fault&1)==1){direction=DIRECTION_SOUTH;}
+		         else{direction=DIRECTION_LOCAL;no_path=30;}
+		      }
+		    else{direction=DIRECTION_LOCAL;no_path=31;}
+           
+	      
+		
+		
+	      	
+	}
+
+	else if(destination.x < current.x && destination.y == current.y)  // if des in W direction
+	{
+		//cout<<"W"<<endl;
+	   int temp = Fault;
+	   int temp2=Fault;
+	   int temp3=Fault;
+	   if(isNeighbor(current, DIRECTION_WEST, destination)&&(temp3&2)==2){direction=DIRECTION_WEST;}
+	 //else if((temp2&1)==1){direction=DIRECTION_SOUTH;}
+
+	   else if((temp&2)==2)
+           {
+		direction=DIRECTION_WEST;
+           }
+		else if((temp2&1)==1){direction=DIRECTION_SOUTH;}
+
+	   else	if(destination.y==NoximGlobalParams::mesh_dim_y-1)
+		{
+		   if((Fault&4)==4){direction=DIRECTION_NORTH;}
+		   else{direction=DIRECTION_LOCAL;no_path=32;}
+		}
+		else if(destination.y==0)
+		{
+		   if((Fault&1)==1){direction=DIRECTION_SOUTH;}
+		   else{direction=DIRECTION_LOCAL;no_path=33;}
+		}
+		else{direction=DIRECTION_LOCAL;no_path=34;}
+           
+	   
+	  
+	     	
+	}
+	else{direction=DIRECTION_LOCAL;}
+	//cout<<"OUTPUT........................................................"<<direction<<endl;
+	
+	return direction;
+
+}
@@ -0,0 +1,97 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the compiled decision table of
+ * the negative-first fault tolerant routing
+ */
+
+#ifndef __NOXIMNEGATIVEFIRSTTABLE_H__
+#define __NOXIMNEGATIVEFIRSTTABLE_H__
+
+#include <vector>
+#include <cstdlib>
+#include "NoximMain.h"
+using namespace std;
+
+// Entries of the table: the output direction, or the no path mark plus
+// the number of the no path message (the output is then DIRECTION_LOCAL)
+#define NFT_NO_PATH        0x80
+#define NFT_UNKNOWN        0xff
+
+// Values of the last hop of a flit (DIRECTION_LOCAL still at the source)
+#define NFT_LAST_HOPS      (DIRECTIONS + 1)
+
+// Neighbor fault masks: bit set when the neighbor can be used
+// (8 east, 4 north, 2 west, 1 south)
+#define NFT_FAULT_MASKS    16
+
+// Class of the position of a node and a destination along one axis:
+// sign of the distance times the predicates the routing looks at
+#define NFT_AXIS_CLASSES   48
+
+// NoximNegativeFirstTable -- the decision of
+// routingNegativeFirstFaultTolerance() compiled into a dense table.
+// The decision depends on the current node and the destination only
+// through a few predicates (quadrant, distance one, which distance is
+// the longer, mesh borders), so the table is indexed by the class of the
+// pair instead of the pair itself and its size does not depend on the
+// mesh. The neighbor fault mask is an index too: the table holds for any
+// fault set.
+class NoximNegativeFirstTable {
+
+  public:
+
+    NoximNegativeFirstTable();
+
+    // Build the table for the current mesh size
+    void compile();
+
+    // Compare the table with reference() for every node, destination,
+    // last hop and neighbor fault mask. Returns the number of mismatches.
+    unsigned long selfCheck(unsigned long &states) const;
+
+    // Table entry for the given state
+    inline unsigned char lookup(const NoximCoord & current,
+				const NoximCoord & destination,
+				const int last_hop, const int fault) const {
+	int dx = destination.x - current.x;
+	int dy = destination.y - current.y;
+	int geometry =
+	    (x_class[current.x * dim_x + destination.x] * NFT_AXIS_CLASSES +
+	     y_class[current.y * dim_y + destination.y]) * 2 +
+	    (abs(dx) >= abs(dy));
+
+	return table[(geometry * NFT_LAST_HOPS + last_hop) * NFT_FAULT_MASKS +
+		     fault];
+    }
+
+    // The original decision function: returns the output direction and
+    // sets no_path to the number of the no path message (0 if none)
+    static int reference(const NoximCoord & current,
+			 const NoximCoord & destination,
+			 const int last_hop, const int fault, int &no_path);
+
+    // Bytes allocated for the table
+    size_t getMemory() const;
+
+  private:
+
+    int dim_x, dim_y;
+    vector < unsigned char >x_class;	// By current.x * dim_x + destination.x
+    vector < unsigned char >y_class;	// By current.y * dim_y + destination.y
+    vector < unsigned char >table;
+
+    static int axisClass(const int distance, const bool current_flag,
+			 const bool destination_low,
+			 const bool destination_high);
+    static bool isNeighbor(const NoximCoord & current, const int direction,
+			   const NoximCoord & destination);
+};
+
+extern NoximNegativeFirstTable NegativeFirstTable;
+
+#endif
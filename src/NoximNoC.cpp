@@ -8,37 +8,77 @@
  * This file contains the implementation of the Network-on-Chip
  */
 
+#include <algorithm>
 #include "NoximNoC.h"
 
+// Offsets of the neighbors, by direction (N, E, S, W)
+static const int neighbor_dx[DIRECTIONS] = { 0, 1, 0, -1 };
+static const int neighbor_dy[DIRECTIONS] = { -1, 0, 1, 0 };
+
+void NoximNoC::allocateMesh()
+{
+    int dim_x = NoximGlobalParams::mesh_dim_x;
+    int dim_y = NoximGlobalParams::mesh_dim_y;
+
+    // One extra row and column for the links on the east and south borders
+    req_to_east.allocate(dim_x + 1, dim_y + 1);
+    req_to_west.allocate(dim_x + 1, dim_y + 1);
+    req_to_south.allocate(dim_x + 1, dim_y + 1);
+    req_to_north.allocate(dim_x + 1, dim_y + 1);
+
+    ack_to_east.allocate(dim_x + 1, dim_y + 1);
+    ack_to_west.allocate(dim_x + 1, dim_y + 1);
+    ack_to_south.allocate(dim_x + 1, dim_y + 1);
+    ack_to_north.allocate(dim_x + 1, dim_y + 1);
+
+    flit_to_east.allocate(dim_x + 1, dim_y + 1);
+    flit_to_west.allocate(dim_x + 1, dim_y + 1);
+    flit_to_south.allocate(dim_x + 1, dim_y + 1);
+    flit_to_north.allocate(dim_x + 1, dim_y + 1);
+
+    free_slots_to_east.allocate(dim_x + 1, dim_y + 1);
+    free_slots_to_west.allocate(dim_x + 1, dim_y + 1);
+    free_slots_to_south.allocate(dim_x + 1, dim_y + 1);
+    free_slots_to_north.allocate(dim_x + 1, dim_y + 1);
+
+    NoP_data_to_east.allocate(dim_x + 1, dim_y + 1);
+    NoP_data_to_west.allocate(dim_x + 1, dim_y + 1);
+    NoP_data_to_south.allocate(dim_x + 1, dim_y + 1);
+    NoP_data_to_north.allocate(dim_x + 1, dim_y + 1);
+
+    t.resize(dim_x, vector < NoximTile * >(dim_y, (NoximTile *) NULL));
+
+    FlitArena.configure(NoximGlobalParams::max_packet_size);
+}
+
 void NoximNoC::buildMesh()
 {
     // Check for routing table availability
     if (NoximGlobalParams::routing_algorithm == ROUTING_TABLE_BASED)
 	assert(grtable.load(NoximGlobalParams::routing_table_filename));
 
+    // The fault tolerant routing looks its decisions up in a table
+    if (NoximGlobalParams::routing_algorithm ==
+	ROUTING_NEGATIVE_FIRST_FAULT_TOLERANCE)
+	NegativeFirstTable.compile();
+
     // Check for traffic table availability
     if (NoximGlobalParams::traffic_distribution == TRAFFIC_TABLE_BASED)
 	assert(gttable.load(NoximGlobalParams::traffic_table_filename));
 
+    // Load the fault events, applied while the simulation runs
+    if (NoximGlobalParams::faults_filename[0] != '\0' &&
+	!fault_schedule.load(NoximGlobalParams::faults_filename))
+	exit(1);
+
     // Create the mesh as a matrix of tiles
     for (int i = 0; i < NoximGlobalParams::mesh_dim_x; i++) {
 	for (int j = 0; j < NoximGlobalParams::mesh_dim_y; j++) {
 	    // Create the single Tile with a proper name
-	    char tile_name[20];
+	    char tile_name[32];
 	    sprintf(tile_name, "Tile[%02d][%02d]", i, j);
 	    t[i][j] = new NoximTile(tile_name);
 
-	    // Tell to the router its coordinates
-	    t[i][j]->r->configure(j * NoximGlobalParams::mesh_dim_x + i,
-				  NoximGlobalParams::stats_warm_up_time,
-				  NoximGlobalParams::buffer_depth,
-				  grtable);
-
-	    // Tell to the PE its coordinates
-	    t[i][j]->pe->local_id = j * NoximGlobalParams::mesh_dim_x + i;
-	    t[i][j]->pe->traffic_table = &gttable;	// Needed to choose destination
-	    t[i][j]->pe->never_transmit = (gttable.occurrencesAsSource(t[i][j]->pe->local_id) == 0);
-
 	    // Map clock and reset
 	    t[i][j]->clock(clock);
 	    t[i][j]->reset(reset);
@@ -149,6 +189,128 @@ void NoximNoC::buildMesh()
 	t[0][j]->r->reservation_table.invalidate(DIRECTION_WEST);
 	t[NoximGlobalParams::mesh_dim_x - 1][j]->r->reservation_table.invalidate(DIRECTION_EAST);
     }
+
+    configureTiles();
+}
+
+void NoximNoC::configureTiles()
+{
+    for (int i = 0; i < NoximGlobalParams::mesh_dim_x; i++)
+	for (int j = 0; j < NoximGlobalParams::mesh_dim_y; j++) {
+	    // Tell to the router its coordinates
+	    t[i][j]->r->configure(j * NoximGlobalParams::mesh_dim_x + i,
+				  NoximGlobalParams::stats_warm_up_time,
+				  NoximGlobalParams::buffer_depth,
+				  grtable);
+
+	    // Tell to the PE its coordinates
+	    t[i][j]->pe->configure(j * NoximGlobalParams::mesh_dim_x + i,
+				   &gttable);
+	}
+
+    // Tell the neighbors of the faulty routers
+    for (unsigned int i = 0; i < FaultRouter.size(); i++)
+	updateNeighborFaults(FaultRouter[i], true);
+
+    // Faults present from the start
+    while (fault_schedule.next() != NULL && fault_schedule.next()->cycle == 0) {
+	applyFaultEvent(*fault_schedule.next());
+	showFaultEvent(*fault_schedule.next());
+	fault_schedule.pop();
+    }
+}
+
+void NoximNoC::restart()
+{
+    // Packet bookkeeping and flits of the previous run
+    SentPacketNumber = 0;
+    packet_budget_start = 0;
+    ReceiveNumber = 0;
+    PacketRegistry.clear();
+    drained_volume = 0;
+    FlitArena.clear();
+
+    fault_schedule.rewind();
+    configureTiles();
+}
+
+void NoximNoC::checkpoint(NoximCheckpoint & cp)
+{
+    cp.transfer(SentPacketNumber);
+    cp.transfer(ReceiveNumber);
+    cp.transfer(drained_volume);
+    cp.transfer(FaultRouter);
+    cp.transfer(NoximGlobalParams::stats_warm_up_time);
+    PacketRegistry.checkpoint(cp);
+    FlitArena.checkpoint(cp);
+
+    for (int i = 0; i < NoximGlobalParams::mesh_dim_x; i++)
+	for (int j = 0; j < NoximGlobalParams::mesh_dim_y; j++) {
+	    t[i][j]->r->checkpoint(cp);
+	    t[i][j]->pe->checkpoint(cp);
+	}
+
+    if (!cp.isRestoring())
+	return;
+
+    const NoximCheckpointHeader & header = cp.getHeader();
+
+    // The packets sent so far do not count against the continuation
+    packet_budget_start = SentPacketNumber;
+
+    if (header.packet_injection_rate != NoximGlobalParams::packet_injection_rate ||
+	header.probability_of_retransmission !=
+	NoximGlobalParams::probability_of_retransmission)
+	for (int i = 0; i < NoximGlobalParams::mesh_dim_x; i++)
+	    for (int j = 0; j < NoximGlobalParams::mesh_dim_y; j++)
+		t[i][j]->pe->shot_window_end = 0.0;
+
+    // Each event sets the state of its router or link: replaying those
+    // already in the checkpoint leaves it unchanged
+    fault_schedule.rewind();
+    while (fault_schedule.next() != NULL &&
+	   fault_schedule.next()->cycle <= header.cycle) {
+	applyFaultEvent(*fault_schedule.next());
+	fault_schedule.pop();
+    }
+}
+
+void NoximNoC::setFault(const int id, const bool faulty)
+{
+    vector < int >::iterator it =
+	find(FaultRouter.begin(), FaultRouter.end(), id);
+
+    if (faulty == (it != FaultRouter.end()))
+	return;
+
+    if (faulty)
+	FaultRouter.push_back(id);
+    else
+	FaultRouter.erase(remove(FaultRouter.begin(), FaultRouter.end(), id),
+			  FaultRouter.end());
+
+    updateNeighborFaults(id, faulty);
+}
+
+void NoximNoC::updateNeighborFaults(const int id, const bool faulty)
+{
+    if (id < 0
+	|| id >= NoximGlobalParams::mesh_dim_x * NoximGlobalParams::mesh_dim_y)
+	return;
+
+    NoximCoord coord = id2Coord(id);
+
+    for (int d = 0; d < DIRECTIONS; d++) {
+	int x = coord.x + neighbor_dx[d];
+	int y = coord.y + neighbor_dy[d];
+
+	if (x < 0 || x >= NoximGlobalParams::mesh_dim_x ||
+	    y < 0 || y >= NoximGlobalParams::mesh_dim_y)
+	    continue;
+
+	// The faulty router is in the opposite direction for the neighbor
+	t[x][y]->r->setNeighborFault((d + 2) % DIRECTIONS, faulty);
+    }
 }
 
 NoximTile *NoximNoC::searchNode(const int id) const
@@ -158,24 +320,172 @@ NoximTile *NoximNoC::searchNode(const int id) const
 	    if (t[i][j]->r->local_id == id)
 		return t[i][j];
 
-    return false;
+    return NULL;
+}
+
+size_t NoximNoC::getTilesMemory() const
+{
+    size_t tile_size = sizeof(NoximTile) + sizeof(NoximRouter) +
+	sizeof(NoximProcessingElement);
+
+    return (size_t) NoximGlobalParams::mesh_dim_x *
+	NoximGlobalParams::mesh_dim_y * tile_size;
+}
+
+size_t NoximNoC::getSignalsMemory() const
+{
+    return req_to_east.getMemory() + req_to_west.getMemory() +
+	req_to_south.getMemory() + req_to_north.getMemory() +
+	ack_to_east.getMemory() + ack_to_west.getMemory() +
+	ack_to_south.getMemory() + ack_to_north.getMemory() +
+	flit_to_east.getMemory() + flit_to_west.getMemory() +
+	flit_to_south.getMemory() + flit_to_north.getMemory() +
+	free_slots_to_east.getMemory() + free_slots_to_west.getMemory() +
+	free_slots_to_south.getMemory() + free_slots_to_north.getMemory() +
+	NoP_data_to_east.getMemory() + NoP_data_to_west.getMemory() +
+	NoP_data_to_south.getMemory() + NoP_data_to_north.getMemory();
 }
 
 void NoximNoC::CheckPacketState()
-{   
-    bool flag = false;
-	
-    if(SentPacketNumber>=SET_SENT_PACKET_NUMBER){
-    for(int i=0;i<PacketState.size();i++)
-    {
-       if(PacketState[i]==STATE_SENT){flag=true;}
+{
+    if (allPacketsSent() && PacketRegistry.getOutstanding() == 0)
+	stopSimulation();
+}
+
+void NoximNoC::setLinkFault(const int id1, const int id2, const bool faulty)
+{
+    NoximCoord c1 = id2Coord(id1);
+    NoximCoord c2 = id2Coord(id2);
+
+    for (int d = 0; d < DIRECTIONS; d++)
+	if (c1.x + neighbor_dx[d] == c2.x && c1.y + neighbor_dy[d] == c2.y) {
+	    t[c1.x][c1.y]->r->setLinkFault(d, faulty);
+	    t[c2.x][c2.y]->r->setLinkFault((d + 2) % DIRECTIONS, faulty);
+	}
+}
+
+void NoximNoC::applyFaultEvent(const NoximFaultEvent & event)
+{
+    if (event.neighbor == NOT_VALID)
+	setFault(event.id, event.faulty);
+    else
+	setLinkFault(event.id, event.neighbor, event.faulty);
+}
+
+void NoximNoC::faultProcess()
+{
+    const NoximFaultEvent *event;
+
+    while ((event = fault_schedule.next()) != NULL &&
+	   event->cycle <= getCurrentCycle()) {
+	applyFaultEvent(*event);
+	showFaultEvent(*event);
+	fault_schedule.pop();
+    }
+}
+
+void NoximNoC::showFaultEvent(const NoximFaultEvent & event) const
+{
+    cout << event.cycle << ": ";
+    if (event.neighbor == NOT_VALID)
+	cout << "Router[" << event.id << "]";
+    else
+	cout << "Link[" << event.id << "-" << event.neighbor << "]";
+    cout << (event.faulty ? " fails" : " recovers") << endl;
+}
+
+int NoximNoC::faultIdleCycles(const int cycles) const
+{
+    const NoximFaultEvent *event = fault_schedule.next();
+
+    if (event == NULL)
+	return cycles;
+
+    // The event is applied on the falling edge of its cycle
+    return min(cycles, max(0, event->cycle - (int) getCurrentCycle()));
+}
+
+void NoximNoC::snapshotProcess()
+{
+    if (!snapshots.enabled() || snapshots.nextCycle() > getCurrentCycle())
+	return;
+
+    NoximSnapshot snapshot;
+
+    snapshot.cycle = (int) getCurrentCycle();
+    snapshot.flits_in_buffers = 0;
+    snapshot.buffers = 0;
+    snapshot.reserved_outputs = 0;
+    snapshot.valid_outputs = 0;
+    snapshot.ejected_flits = 0;
+
+    for (int y = 0; y < NoximGlobalParams::mesh_dim_y; y++)
+	for (int x = 0; x < NoximGlobalParams::mesh_dim_x; x++) {
+	    NoximRouter *r = t[x][y]->r;
+
+	    snapshot.flits_in_buffers += r->getFlitsCount();
+	    snapshot.buffers += DIRECTIONS + 1;
+	    r->reservation_table.getUsage(snapshot.reserved_outputs,
+					  snapshot.valid_outputs);
+	    snapshot.ejected_flits += r->getEjectedFlits();
+	}
+
+    snapshot.sent_packets = SentPacketNumber;
+    snapshot.received_packets = ReceiveNumber;
+    snapshot.no_path_packets = PacketRegistry.getCount(STATE_NO_PATH);
+
+    snapshots.write(snapshot);
+}
+
+int NoximNoC::snapshotIdleCycles(const int cycles) const
+{
+    if (!snapshots.enabled())
+	return cycles;
+
+    // Same timing as a fault event
+    return min(cycles, max(0, snapshots.nextCycle() - (int) getCurrentCycle()));
+}
+
+void NoximNoC::convergenceProcess()
+{
+    if (!convergence.enabled() || convergence.nextCycle() > getCurrentCycle())
+	return;
+
+    unsigned long packets = 0, flits = 0;
+    double delay = 0.0;
+
+    for (int y = 0; y < NoximGlobalParams::mesh_dim_y; y++)
+	for (int x = 0; x < NoximGlobalParams::mesh_dim_x; x++) {
+	    NoximRouter *r = t[x][y]->r;
+
+	    packets += r->getEjectedPackets();
+	    delay += r->getEjectedDelay();
+	    flits += r->getEjectedFlits();
+	}
+
+    int cycle = (int) getCurrentCycle();
+
+    switch (convergence.addBatch(cycle, packets, delay, flits)) {
+    case STEADY_WARMED_UP:
+	// The statistics start over from here, as if -warmup said so
+	NoximGlobalParams::stats_warm_up_time = cycle - DEFAULT_RESET_TIME;
+	for (int y = 0; y < NoximGlobalParams::mesh_dim_y; y++)
+	    for (int x = 0; x < NoximGlobalParams::mesh_dim_x; x++)
+		t[x][y]->r->stats.restart(NoximGlobalParams::
+					  stats_warm_up_time);
+	break;
+
+    case STEADY_CONVERGED:
+	stopSimulation();
+	break;
     }
-    if(flag){;}
-    else if(!flag)
-	{
-		j++;
-		if(j==1000){sc_stop();}
-		
-		}
-   }
+}
+
+int NoximNoC::convergenceIdleCycles(const int cycles) const
+{
+    if (!convergence.enabled())
+	return cycles;
+
+    return min(cycles,
+	       max(0, convergence.nextCycle() - (int) getCurrentCycle()));
 }
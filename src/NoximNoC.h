@@ -15,8 +15,49 @@
 #include "NoximTile.h"
 #include "NoximGlobalRoutingTable.h"
 #include "NoximGlobalTrafficTable.h"
+#include "NoximFaultSchedule.h"
+#include "NoximSnapshot.h"
+#include "NoximConvergence.h"
+#include "NoximCheckpoint.h"
 using namespace std;
 
+// NoximSignalMatrix -- grid of link signals indexed as m[x][y], sized
+// from the mesh at elaboration. Signals cannot be copied, so they live
+// in a single array rather than in nested vectors.
+template < class T > class NoximSignalMatrix {
+  public:
+    NoximSignalMatrix():signals(NULL), size_x(0), size_y(0) {
+    }
+
+    ~NoximSignalMatrix() {
+	delete[]signals;
+    }
+
+    void allocate(const int _size_x, const int _size_y) {
+	assert(signals == NULL);
+	size_x = _size_x;
+	size_y = _size_y;
+	signals = new sc_signal < T >[size_x * size_y];
+    }
+
+    inline sc_signal < T > *operator[] (const int x) {
+	return signals + x * size_y;
+    }
+
+    // Bytes taken by the signals
+    size_t getMemory() const {
+	return (size_t) size_x * size_y * sizeof(sc_signal < T >);
+    }
+
+  private:
+    sc_signal < T > *signals;
+    int size_x;
+    int size_y;
+
+    NoximSignalMatrix(const NoximSignalMatrix &);
+    NoximSignalMatrix & operator=(const NoximSignalMatrix &);
+};
+
 SC_MODULE(NoximNoC)
 {
 
@@ -25,88 +66,122 @@ SC_MODULE(NoximNoC)
     sc_in < bool > reset;	// The reset signal for the NoC
 
     // Signals
-    sc_signal <bool> req_to_east[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
-    sc_signal <bool> req_to_west[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
-    sc_signal <bool> req_to_south[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
-    sc_signal <bool> req_to_north[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
-
-    sc_signal <bool> ack_to_east[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
-    sc_signal <bool> ack_to_west[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
-    sc_signal <bool> ack_to_south[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
-    sc_signal <bool> ack_to_north[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
-
-    sc_signal <NoximFlit> flit_to_east[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
-    sc_signal <NoximFlit> flit_to_west[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
-    sc_signal <NoximFlit> flit_to_south[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
-    sc_signal <NoximFlit> flit_to_north[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
-
-    sc_signal <int> free_slots_to_east[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
-    sc_signal <int> free_slots_to_west[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
-    sc_signal <int> free_slots_to_south[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
-    sc_signal <int> free_slots_to_north[MAX_STATIC_DIM + 1][MAX_STATIC_DIM + 1];
+    NoximSignalMatrix < bool > req_to_east;
+    NoximSignalMatrix < bool > req_to_west;
+    NoximSignalMatrix < bool > req_to_south;
+    NoximSignalMatrix < bool > req_to_north;
+
+    NoximSignalMatrix < bool > ack_to_east;
+    NoximSignalMatrix < bool > ack_to_west;
+    NoximSignalMatrix < bool > ack_to_south;
+    NoximSignalMatrix < bool > ack_to_north;
+
+    NoximSignalMatrix < NoximFlitHandle > flit_to_east;
+    NoximSignalMatrix < NoximFlitHandle > flit_to_west;
+    NoximSignalMatrix < NoximFlitHandle > flit_to_south;
+    NoximSignalMatrix < NoximFlitHandle > flit_to_north;
+
+    NoximSignalMatrix < int > free_slots_to_east;
+    NoximSignalMatrix < int > free_slots_to_west;
+    NoximSignalMatrix < int > free_slots_to_south;
+    NoximSignalMatrix < int > free_slots_to_north;
 
     // NoP
-    sc_signal <NoximNoP_data> NoP_data_to_east[MAX_STATIC_DIM][MAX_STATIC_DIM];
-    sc_signal <NoximNoP_data> NoP_data_to_west[MAX_STATIC_DIM][MAX_STATIC_DIM];
-    sc_signal <NoximNoP_data> NoP_data_to_south[MAX_STATIC_DIM][MAX_STATIC_DIM];
-    sc_signal <NoximNoP_data> NoP_data_to_north[MAX_STATIC_DIM][MAX_STATIC_DIM];
+    NoximSignalMatrix < NoximNoP_data > NoP_data_to_east;
+    NoximSignalMatrix < NoximNoP_data > NoP_data_to_west;
+    NoximSignalMatrix < NoximNoP_data > NoP_data_to_south;
+    NoximSignalMatrix < NoximNoP_data > NoP_data_to_north;
 
     // Matrix of tiles
-    NoximTile *t[MAX_STATIC_DIM][MAX_STATIC_DIM];
+    vector < vector < NoximTile * > > t;
 
     // Global tables
     NoximGlobalRoutingTable grtable;
     NoximGlobalTrafficTable gttable;
+    NoximFaultSchedule fault_schedule;
 
-    //---------- Mau experiment <start>
-    void flitsMonitor() {
+    // Periodic metrics, written while the file is open
+    NoximSnapshotFile snapshots;
 
-	if (!reset.read()) {
-	    //      if ((int)sc_simulation_time() % 5)
-	    //        return;
-
-	    unsigned int count = 0;
-	    for (int i = 0; i < NoximGlobalParams::mesh_dim_x; i++)
-		for (int j = 0; j < NoximGlobalParams::mesh_dim_y; j++)
-		    count += t[i][j]->r->getFlitsCount();
-	    cout << count << endl;
-	}
-    }
-
-    //bool CheckPacketState();
-    //---------- Mau experiment <stop>
+    // Steady state detection, enabled once configured
+    NoximConvergenceMonitor convergence;
 
     // Constructor
 
     SC_CTOR(NoximNoC) {
 
-	//---------- Mau experiment <start>
-	/*
-	   SC_METHOD(flitsMonitor);
-	   sensitive(reset);
-	   sensitive_pos(clock);
-	 */
-	//---------- Mau experiment <stop>
-
 	// Build the Mesh
+	allocateMesh();
 	buildMesh();
     
         SC_METHOD(CheckPacketState);
 	//sensitive << reset;
 	//sensitive << clock.neg();
         sensitive << clock.neg();
+
+	SC_METHOD(faultProcess);
+	sensitive << clock.neg();
+
+	SC_METHOD(snapshotProcess);
+	sensitive << clock.neg();
+
+	SC_METHOD(convergenceProcess);
+	sensitive << clock.neg();
     }
 
     // Support methods
     NoximTile *searchNode(const int id) const;
-    
-    
-    
+    // Stops the simulation once every packet has been sent and has left
+    // the network
+    void CheckPacketState();
+
+    // Brings every tile back to its state after elaboration, with the
+    // faulty routers currently in FaultRouter, and forgets the packets of
+    // the previous run, so that the NoC can be simulated again from time
+    // zero
+    void restart();
+
+    // Saves the packet bookkeeping and the state of every tile, or
+    // restores them. On restore the fault events scheduled up to the
+    // cycle of the checkpoint are applied at once, and the PEs draw their
+    // next shot again if the injection rates have changed
+    void checkpoint(NoximCheckpoint & cp);
+
+    // Adds the router to the faulty ones, or removes it, updating the
+    // neighbor fault masks of the routers around it
+    void setFault(const int id, const bool faulty);
+    // Same for the link between two neighbor routers
+    void setLinkFault(const int id1, const int id2, const bool faulty);
+
+    // Applies the scheduled fault events that are due
+    void faultProcess();
+    // Up to 'cycles' cycles that can be skipped before the next fault event
+    int faultIdleCycles(const int cycles) const;
+
+    // Writes a snapshot of the metrics when one is due
+    void snapshotProcess();
+    // Up to 'cycles' cycles that can be skipped before the next snapshot
+    int snapshotIdleCycles(const int cycles) const;
+
+    // Ends a batch of the steady state detection when one is due: ends
+    // the warm-up of the statistics or the simulation accordingly
+    void convergenceProcess();
+    // Up to 'cycles' cycles that can be skipped before the next batch ends
+    int convergenceIdleCycles(const int cycles) const;
+
+    // Bytes allocated at elaboration for the tiles and the link signals
+    size_t getTilesMemory() const;
+    size_t getSignalsMemory() const;
+
 
   private:
 
+    void allocateMesh();
     void buildMesh();
-    void CheckPacketState();
+    void configureTiles();
+    void updateNeighborFaults(const int id, const bool faulty);
+    void applyFaultEvent(const NoximFaultEvent & event);
+    void showFaultEvent(const NoximFaultEvent & event) const;
 };
 
 #endif
@@ -0,0 +1,70 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the packet registry
+ */
+
+#include "NoximPacketRegistry.h"
+
+NoximPacketRegistry::NoximPacketRegistry()
+{
+    clear();
+}
+
+void NoximPacketRegistry::clear()
+{
+    states.clear();
+    for (int i = 0; i < PACKET_STATES; i++)
+	counts[i] = 0;
+    outstanding = 0;
+    delivered = 0;
+}
+
+int NoximPacketRegistry::create()
+{
+    states.push_back(STATE_NOT_SENT);
+    counts[STATE_NOT_SENT]++;
+    outstanding++;
+
+    return states.size() - 1;
+}
+
+void NoximPacketRegistry::setSent(const int id)
+{
+    if (getState(id) == STATE_NOT_SENT)
+	setState(id, STATE_SENT);
+}
+
+void NoximPacketRegistry::setState(const int id, const int state)
+{
+    counts[getState(id)]--;
+    counts[state]++;
+    states[id] = (states[id] & PACKET_EJECTED) | state;
+}
+
+void NoximPacketRegistry::setEjected(const int id)
+{
+    assert(!(states[id] & PACKET_EJECTED));
+    assert(outstanding > 0);
+    states[id] |= PACKET_EJECTED;
+    outstanding--;
+    if (getState(id) == STATE_SUCCESS)
+	delivered++;
+}
+
+void NoximPacketRegistry::checkpoint(NoximCheckpoint & cp)
+{
+    cp.transfer(states);
+    cp.transfer(counts, PACKET_STATES);
+    cp.transfer(outstanding);
+    cp.transfer(delivered);
+}
+
+size_t NoximPacketRegistry::getMemory() const
+{
+    return states.capacity();
+}
@@ -0,0 +1,93 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the packet registry
+ */
+
+#ifndef __NOXIMPACKETREGISTRY_H__
+#define __NOXIMPACKETREGISTRY_H__
+
+#include <vector>
+#include "NoximMain.h"
+#include "NoximCheckpoint.h"
+using namespace std;
+
+// Bit of the state byte set once the tail flit has left the network
+#define PACKET_EJECTED         0x80
+
+// NoximPacketRegistry -- state of every packet generated so far (one byte
+// each, indexed by packet id), with the number of packets in each state
+// and the number of packets still outstanding kept up to date at every
+// change, so that no query has to scan the packets.
+//
+// A packet is outstanding from its creation until its tail flit leaves
+// the network, either at the destination or at the router where no path
+// was found. The ejection is recorded in the state byte of the packet, so
+// that a packet ejected twice is caught.
+class NoximPacketRegistry {
+
+  public:
+
+    NoximPacketRegistry();
+
+    // Forget every packet
+    void clear();
+
+    // New packet, not sent yet: returns its id
+    int create();
+
+    // Every flit of the packet has left its PE. A packet whose outcome is
+    // already known keeps it
+    void setSent(const int id);
+
+    // Outcome of the packet, decided by the routers
+    void setState(const int id, const int state);
+
+    // The tail flit of the packet has left the network
+    void setEjected(const int id);
+
+    inline int getState(const int id) const {
+	return states[id] & ~PACKET_EJECTED;
+    }
+
+    // Packets generated so far
+    inline unsigned int size() const {
+	return states.size();
+    }
+
+    // Packets currently in the given state
+    inline unsigned int getCount(const int state) const {
+	return counts[state];
+    }
+
+    // Packets not yet sent or with flits still in the network
+    inline unsigned int getOutstanding() const {
+	return outstanding;
+    }
+
+    // Packets whose tail flit has left the network at the destination
+    inline unsigned int getDelivered() const {
+	return delivered;
+    }
+
+    // Save the packets, or restore them
+    void checkpoint(NoximCheckpoint & cp);
+
+    // Bytes allocated for the packet states
+    size_t getMemory() const;
+
+  private:
+
+    vector < unsigned char >states;
+    unsigned int counts[PACKET_STATES];
+    unsigned int outstanding;
+    unsigned int delivered;
+};
+
+extern NoximPacketRegistry PacketRegistry;
+
+#endif
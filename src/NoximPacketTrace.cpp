@@ -0,0 +1,70 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the packet lifecycle trace
+ */
+
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "NoximPacketTrace.h"
+
+NoximPacketTrace::NoximPacketTrace()
+{
+    header = NULL;
+    records = NULL;
+    next = 0;
+    length = 0;
+}
+
+NoximPacketTrace::~NoximPacketTrace()
+{
+    close();
+}
+
+bool NoximPacketTrace::open(const char *fname,
+			    const unsigned long long capacity)
+{
+    close();
+
+    int fd = ::open(fname, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+	return false;
+
+    length = sizeof(NoximTraceHeader) + capacity * sizeof(NoximTraceRecord);
+
+    void *map = MAP_FAILED;
+    if (ftruncate(fd, length) == 0)
+	map = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (map == MAP_FAILED)
+	return false;
+
+    header = (NoximTraceHeader *) map;
+    records = (NoximTraceRecord *) (header + 1);
+    next = 0;
+
+    memcpy(header->magic, TRACE_MAGIC, sizeof(header->magic));
+    header->version = TRACE_VERSION;
+    header->record_size = sizeof(NoximTraceRecord);
+    header->capacity = capacity;
+    header->written = 0;
+
+    return true;
+}
+
+void NoximPacketTrace::close()
+{
+    if (header == NULL)
+	return;
+
+    munmap(header, length);
+    header = NULL;
+    records = NULL;
+}
@@ -0,0 +1,95 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the packet lifecycle trace
+ */
+
+#ifndef __NOXIMPACKETTRACE_H__
+#define __NOXIMPACKETTRACE_H__
+
+// Only standard headers: the decoder in ../other includes this file too
+#include <cstddef>
+
+// Record types, with the meaning of their router, direction and value
+#define TRACE_INJECT           0	// Source PE, -, destination id
+#define TRACE_HOP              1	// Router, output direction, -
+#define TRACE_DELIVER          2	// Destination router, -, -
+#define TRACE_NO_PATH          3	// Router where no path was found, -, -
+#define TRACE_EJECT            4	// Router where the tail left the network
+
+#define TRACE_MAGIC            "NOXIMTRC"
+#define TRACE_VERSION          1
+
+// NoximTraceHeader -- start of the trace file, followed by 'capacity'
+// record slots. Record k is in slot k % capacity, so once more than
+// 'capacity' records have been written only the newest ones are left.
+struct NoximTraceHeader {
+    char magic[8];
+    unsigned int version;
+    unsigned int record_size;
+    unsigned long long capacity;	// Record slots in the file
+    unsigned long long written;	// Records written so far
+};
+
+// NoximTraceRecord -- one event of the life of a packet. Hops are those
+// of the head flit, the path of every other flit of the packet.
+struct NoximTraceRecord {
+    unsigned int cycle;
+    int packet_id;
+    unsigned short router;
+    unsigned char type;
+    unsigned char direction;
+    int value;
+};
+
+// NoximPacketTrace -- fixed size records appended to a ring of slots in
+// a memory mapped file: appending a record is a store into memory, the
+// operating system writes the pages out. The file can be decoded even
+// if the simulation does not complete.
+//
+// The trace is written by one thread only: routers running in the
+// worker threads of the native engine defer their records like the
+// other updates to the global bookkeeping.
+class NoximPacketTrace {
+
+  public:
+
+    NoximPacketTrace();
+    ~NoximPacketTrace();
+
+    // Create the file with room for 'capacity' records. Returns false
+    // if the file cannot be created or mapped
+    bool open(const char *fname, const unsigned long long capacity);
+
+    // Unmap the file, leaving the records written so far
+    void close();
+
+    inline bool enabled() const {
+	return records != NULL;
+    }
+
+    inline void append(const NoximTraceRecord & record) {
+	records[next] = record;
+	if (++next == header->capacity)
+	    next = 0;
+	header->written++;
+    }
+
+  private:
+
+    NoximTraceHeader *header;
+    NoximTraceRecord *records;
+    unsigned long long next;	// Slot of the next record
+    size_t length;		// Bytes mapped
+
+    NoximPacketTrace(const NoximPacketTrace &);
+    NoximPacketTrace & operator=(const NoximPacketTrace &);
+};
+
+extern NoximPacketTrace PacketTrace;
+
+#endif
@@ -0,0 +1,122 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the ports used by routers and
+ * processing elements, which can be driven either by SystemC signals
+ * or by the wires of the native engine
+ */
+
+#ifndef __NOXIMPORT_H__
+#define __NOXIMPORT_H__
+
+#include <vector>
+#include <systemc.h>
+using namespace std;
+
+template < class T > struct NoximWire;
+
+// NoximWireQueue -- wires written in the current cycle, waiting for the
+// update. Each thread of the native engine fills its own queue.
+template < class T > struct NoximWireQueue {
+    vector < NoximWire < T > *>wires;
+
+    void commit();
+};
+
+// NoximWire -- two-phase storage for one signal of the native engine.
+// Writes go to nxt and become visible in cur only after the commit of
+// the queue, exactly like the evaluate/update phases of an sc_signal.
+// Written wires are queued so that the update touches only those.
+template < class T > struct NoximWire {
+    T cur;			// Value seen by readers in the current cycle
+    T nxt;			// Value written in the current cycle
+    bool dirty;			// Queued for the next update
+    NoximWireQueue < T > *queue;	// Where the wire is queued when written
+
+    static NoximWireQueue < T > pending;	// Default queue
+
+    NoximWire():cur(), nxt(), dirty(false), queue(&pending) {
+    }
+
+    inline void init(const T & v) {
+	cur = nxt = v;
+    }
+
+    inline void write(const T & v) {
+	nxt = v;
+	if (!dirty) {
+	    dirty = true;
+	    queue->wires.push_back(this);
+	}
+    }
+
+    static void commitAll() {
+	pending.commit();
+    }
+};
+
+template < class T > NoximWireQueue < T > NoximWire < T >::pending;
+
+template < class T > void NoximWireQueue < T >::commit()
+{
+    for (unsigned int i = 0; i < wires.size(); i++) {
+	wires[i]->cur = wires[i]->nxt;
+	wires[i]->dirty = false;
+    }
+    wires.clear();
+}
+
+// NoximIn -- input port reading either the bound signal or an attached wire
+template < class T > class NoximIn:public sc_in < T > {
+  public:
+    NoximIn():wire(NULL) {
+    }
+
+    void attach(NoximWire < T > *_wire) {
+	wire = _wire;
+    }
+
+    inline const T & read() const {
+	if (wire)
+	    return wire->cur;
+	return sc_in < T >::read();
+    }
+
+    inline operator const T & () const {
+	return read();
+    }
+
+  private:
+    NoximWire < T > *wire;
+};
+
+// NoximOut -- output port writing either the bound signal or an attached wire
+template < class T > class NoximOut:public sc_out < T > {
+  public:
+    NoximOut():wire(NULL) {
+    }
+
+    void attach(NoximWire < T > *_wire) {
+	wire = _wire;
+    }
+
+    NoximWire < T > *getWire() const {
+	return wire;
+    }
+
+    inline void write(const T & v) {
+	if (wire)
+	    wire->write(v);
+	else
+	    sc_out < T >::write(v);
+    }
+
+  private:
+    NoximWire < T > *wire;
+};
+
+#endif
@@ -27,7 +27,7 @@ bool   NoximPower::power_data_loaded = false;
 
 NoximPower::NoximPower()
 {
-  pwr = 0.0;
+  Reset();
 
   if (!power_data_loaded)
     {
@@ -36,6 +36,18 @@ NoximPower::NoximPower()
     }
 }
 
+void NoximPower::Reset()
+{
+  pwr = 0.0;
+  leakage_count = 0;
+}
+
+void NoximPower::checkpoint(NoximCheckpoint & cp)
+{
+  cp.transfer(pwr);
+  cp.transfer(leakage_count);
+}
+
 void NoximPower::Routing()
 {
   pwr += pwr_routing;
@@ -66,9 +78,11 @@ void NoximPower::Crossbar()
   pwr += pwr_crossbar;
 }
 
-void NoximPower::Leakage()
+void NoximPower::Leakage(const unsigned long times)
 {
-  pwr += pwr_leakage;
+  // Counted rather than summed, so that idle cycles can be accounted
+  // in bulk with the same result
+  leakage_count += times;
 }
 
 void NoximPower::EndToEnd()
@@ -13,6 +13,7 @@
 
 #include <cassert>
 #include "NoximMain.h"
+#include "NoximCheckpoint.h"
 using namespace std;
 
 /*
@@ -60,12 +61,16 @@ class NoximPower {
     void Crossbar();
     void Link(bool low_voltage);
     void EndToEnd();
-    void Leakage();
+    void Leakage(const unsigned long times = 1);
+
+    void Reset();		// Forget the energy accounted so far
+
+    void checkpoint(NoximCheckpoint & cp);	// Save the energy accounted so far, or restore it
 
     bool LoadPowerData(const char *fname);
 
     double getPower() {
-	return pwr;
+	return pwr + leakage_count * pwr_leakage;
     } 
 
     double getPwrRouting() {
@@ -118,6 +123,7 @@ class NoximPower {
     static bool   power_data_loaded;
 
     double pwr;
+    unsigned long long leakage_count;	// Leakage() events, accounted at the end
 };
 
 #endif
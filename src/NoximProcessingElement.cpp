@@ -8,27 +8,49 @@
  * This file contains the implementation of the processing element
  */
 
+#include <cfloat>
 #include "NoximProcessingElement.h"
 
 int NoximProcessingElement::randInt(int min, int max)
 {
     return min +
-	(int) ((double) (max - min + 1) * rand() / (RAND_MAX + 1.0));
+	(int) ((double) (max - min + 1) * rng.next() / (NOXIM_RAND_MAX + 1.0));
+}
+
+void NoximProcessingElement::configure(const int _id,
+				       NoximGlobalTrafficTable * _traffic_table)
+{
+    local_id = _id;
+    traffic_table = _traffic_table;	// Needed to choose destination
+    never_transmit = (traffic_table->occurrencesAsSource(local_id) == 0);
+    rng.seed(NoximGlobalParams::rnd_generator_seed, 2 * local_id + 1);
+
+    packet_queue = queue < NoximPacket > ();
+    moved_flits = false;
+    shot_countdown = 0;
+    shot_window_end = 0.0;
 }
 
 void NoximProcessingElement::rxProcess()
 {
+    moved_flits = false;
+
     if (reset.read()) {
 	ack_rx.write(0);
 	current_level_rx = 0;
     } else {
 	if (req_rx.read() == 1 - current_level_rx) {
-	    NoximFlit flit_tmp = flit_rx.read();
+	    NoximFlitHandle handle = flit_rx.read();
+	    const NoximFlit & flit_tmp = FlitArena[handle];
 	    if (NoximGlobalParams::verbose_mode > VERBOSE_OFF) {
-		cout << sc_simulation_time() << ": ProcessingElement[" <<
+		cout << getCurrentCycle() << ": ProcessingElement[" <<
 		    local_id << "] RECEIVING " << flit_tmp << endl;
 	    }
+	    // The whole packet has been delivered: recycle its flits
+	    if (flit_tmp.flit_type == FLIT_TYPE_TAIL)
+		FlitArena.releasePacket(handle);
 	    current_level_rx = 1 - current_level_rx;	// Negate the old value for Alternating Bit Protocol (ABP)
+	    moved_flits = true;
 	}
 	ack_rx.write(current_level_rx);
     }
@@ -40,6 +62,7 @@ void NoximProcessingElement::txProcess()
 	req_tx.write(0);
 	current_level_tx = 0;
 	transmittedAtPreviousCycle = false;
+	shot_window_end = 0.0;	// Next shot drawn at the first cycle
     } else {
 	NoximPacket packet;
 
@@ -54,37 +77,56 @@ void NoximProcessingElement::txProcess()
 
 	if (ack_tx.read() == current_level_tx) {
 	    if (!packet_queue.empty()) {
-		NoximFlit flit = nextFlit();	// Generate a new flit
+		NoximFlitHandle handle = nextFlit();	// Generate a new flit
 		if (NoximGlobalParams::verbose_mode > VERBOSE_OFF) {
-		    cout << sc_time_stamp().to_double() /
-			1000 << ": ProcessingElement[" << local_id <<
-			"] SENDING " << flit << endl;
+		    cout << getCurrentCycle() << ": ProcessingElement[" << local_id <<
+			"] SENDING " << FlitArena[handle] << endl;
 		}
-		flit_tx->write(flit);	// Send the generated flit
+		flit_tx.write(handle);	// Send the generated flit
 		current_level_tx = 1 - current_level_tx;	// Negate the old value for Alternating Bit Protocol (ABP)
 		req_tx.write(current_level_tx);
+		moved_flits = true;
 	    }
 	}
     }
 }
 
-NoximFlit NoximProcessingElement::nextFlit()
+NoximFlitHandle NoximProcessingElement::nextFlit()
 {
-    NoximFlit flit;
     NoximPacket packet = packet_queue.front();
 
+    // All the flits of a packet are created in one arena block
+    if (packet.size == packet.flit_left)
+	packet_flits = FlitArena.allocatePacket();
+
+    NoximFlitHandle handle = packet_flits + packet.size - packet.flit_left;
+    NoximFlit & flit = FlitArena[handle];
+
     flit.src_id = packet.src_id;
     flit.dst_id = packet.dst_id;
     flit.flit_id = packet.packet_id;
-    flit.timestamp = packet.timestamp;
+    flit.timestamp = (unsigned int) packet.timestamp;
     flit.sequence_no = packet.size - packet.flit_left;
     flit.hop_no = 0;
+    flit.last_hop = DIRECTION_LOCAL;
     //  flit.payload= DEFAULT_PAYLOAD;
+    flit.payload.data = 0;
     flit.use_low_voltage_path = packet.use_low_voltage_path;
-    flit.FlitPath.push_back(DIRECTION_LOCAL);
-    if (packet.size == packet.flit_left)
+    if (packet.size == packet.flit_left) {
 	flit.flit_type = FLIT_TYPE_HEAD;
-    else if (packet.flit_left == 1)
+
+	if (PacketTrace.enabled()) {
+	    NoximTraceRecord record;
+
+	    record.cycle = (unsigned int) getCurrentCycle();
+	    record.packet_id = packet.packet_id;
+	    record.router = local_id;
+	    record.type = TRACE_INJECT;
+	    record.direction = DIRECTION_LOCAL;
+	    record.value = packet.dst_id;
+	    PacketTrace.append(record);
+	}
+    } else if (packet.flit_left == 1)
 	flit.flit_type = FLIT_TYPE_TAIL;
     else
 	flit.flit_type = FLIT_TYPE_BODY;
@@ -95,64 +137,73 @@ NoximFlit NoximProcessingElement::nextFlit()
     if (packet_queue.front().flit_left == 0)
 	{
 	packet_queue.pop();
-        PacketState[PackedIndex]=STATE_SENT;
-        cout<<"PACKETID"<<packet.packet_id<<"------------DESTINATION ID"<<packet.dst_id<<endl;
+        PacketRegistry.setSent(packet.packet_id);
+        EventLog.write(LOG_PACKETS, (unsigned int) getCurrentCycle(),
+		       EVENT_PACKET_SENT, packet.packet_id, packet.dst_id);
 		//Path[packet.packet_id].push_back(DIRECTION_LOCAL);
-         if(SentPacketNumber<SET_SENT_PACKET_NUMBER){SentPacketNumber++;}
+         if(!allPacketsSent()){SentPacketNumber++;}
         
         }
 
-    return flit;
+    return handle;
 }
 
 bool NoximProcessingElement::canShot(NoximPacket & packet)
 {
-    bool shot;
-    double threshold;
+    if (NoximGlobalParams::traffic_distribution == TRAFFIC_TABLE_BASED
+	&& never_transmit)
+	return false;
+
+    // Once all the packets have been sent nothing is drawn any more
+    if (allPacketsSent())
+	return false;
+
+    double now = getCurrentCycle();
+
+    // After a reset, or when the active communications of the traffic
+    // table change, the next shot is drawn again with the new rates
+    if (now >= shot_window_end)
+	scheduleShot(now, false);
+
+    if (shot_countdown > 0) {
+	shot_countdown--;
+	return false;
+    }
 
     if (NoximGlobalParams::traffic_distribution != TRAFFIC_TABLE_BASED) {
-	if (!transmittedAtPreviousCycle)
-	    threshold = NoximGlobalParams::packet_injection_rate;
-	else
-	    threshold = NoximGlobalParams::probability_of_retransmission;
-
-	shot = (((double) rand()) / RAND_MAX < threshold)&&(SentPacketNumber<SET_SENT_PACKET_NUMBER);
-	if (shot) {
-	    switch (NoximGlobalParams::traffic_distribution) {
-	    case TRAFFIC_RANDOM:
-		packet = trafficRandom();
-		break;
+	switch (NoximGlobalParams::traffic_distribution) {
+	case TRAFFIC_RANDOM:
+	    packet = trafficRandom();
+	    break;
 
-	    case TRAFFIC_TRANSPOSE1:
-		packet = trafficTranspose1();
-		break;
+	case TRAFFIC_TRANSPOSE1:
+	    packet = trafficTranspose1();
+	    break;
 
-	    case TRAFFIC_TRANSPOSE2:
-		packet = trafficTranspose2();
-		break;
+	case TRAFFIC_TRANSPOSE2:
+	    packet = trafficTranspose2();
+	    break;
 
-	    case TRAFFIC_BIT_REVERSAL:
-		packet = trafficBitReversal();
-		break;
+	case TRAFFIC_BIT_REVERSAL:
+	    packet = trafficBitReversal();
+	    break;
 
-	    case TRAFFIC_SHUFFLE:
-		packet = trafficShuffle();
-		break;
+	case TRAFFIC_SHUFFLE:
+	    packet = trafficShuffle();
+	    break;
 
-	    case TRAFFIC_BUTTERFLY:
-		packet = trafficButterfly();
-		break;
+	case TRAFFIC_BUTTERFLY:
+	    packet = trafficButterfly();
+	    break;
 
-	    default:
-		assert(false);
-	    }
-	    setUseLowVoltagePath(packet);
+	default:
+	    assert(false);
 	}
+	setUseLowVoltagePath(packet);
+	packet.packet_id = PacketRegistry.create();
+	EventLog.write(LOG_PACKETS, (unsigned int) now, EVENT_PACKET_CREATED,
+		       local_id, packet.packet_id);
     } else {			// Table based communication traffic
-	if (never_transmit)
-	    return false;
-
-	double now = sc_time_stamp().to_double() / 1000;
 	bool use_pir = (transmittedAtPreviousCycle == false);
 	vector < pair < int, double > > dst_prob;
 	vector <bool> use_low_voltage_path;
@@ -160,28 +211,146 @@ bool NoximProcessingElement::canShot(NoximPacket & packet)
 	    traffic_table->getCumulativePirPor(local_id, (int) now,
 					       use_pir, dst_prob, use_low_voltage_path);
 
-	double prob = (double) rand() / RAND_MAX;
-	shot = (prob < threshold);
-	if (shot) {
-	    for (unsigned int i = 0; i < dst_prob.size(); i++) {
-		if (prob < dst_prob[i].second) {
-		    packet.make(local_id, dst_prob[i].first, now,
-				getRandomSize());
-		    packet.use_low_voltage_path = use_low_voltage_path[i];
-		    break;
-		}
+	// Destination with probability proportional to its rate
+	double prob = threshold * rng.next() / (NOXIM_RAND_MAX + 1.0);
+	for (unsigned int i = 0; i < dst_prob.size(); i++) {
+	    if (prob < dst_prob[i].second) {
+		packet.make(local_id, dst_prob[i].first, now,
+			    getRandomSize());
+		packet.use_low_voltage_path = use_low_voltage_path[i];
+		packet.packet_id = PacketRegistry.create();
+		EventLog.write(LOG_PACKETS, (unsigned int) now,
+			       EVENT_PACKET_CREATED, local_id,
+			       packet.packet_id);
+		break;
 	    }
 	}
     }
 
-    return shot;
+    scheduleShot(now + 1, true);
+
+    return true;
+}
+
+double NoximProcessingElement::shotProbability(const double cycle,
+					       const bool use_pir,
+					       double &window_end)
+{
+    if (NoximGlobalParams::traffic_distribution != TRAFFIC_TABLE_BASED) {
+	window_end = DBL_MAX;
+	return use_pir ? NoximGlobalParams::packet_injection_rate :
+	    NoximGlobalParams::probability_of_retransmission;
+    }
+
+    vector < pair < int, double > > dst_prob;
+    vector <bool> use_low_voltage_path;
+
+    window_end = traffic_table->getNextChange(local_id, (int) cycle);
+    return traffic_table->getCumulativePirPor(local_id, (int) cycle,
+					      use_pir, dst_prob,
+					      use_low_voltage_path);
+}
+
+int NoximProcessingElement::geometric(const double p)
+{
+    if (p >= 1.0)
+	return 0;
+    if (p <= 0.0)
+	return INT_MAX;		// Never, within any simulation time
+
+    // Failures before the first success, by inversion
+    double u = (rng.next() + 1.0) / (NOXIM_RAND_MAX + 1.0);
+    double failures = floor(log(u) / log1p(-p));
+
+    return (failures < INT_MAX) ? (int) failures : INT_MAX;
+}
+
+void NoximProcessingElement::scheduleShot(const double cycle,
+					  const bool after_shot)
+{
+    // Right after a shot the first cycle uses the probability of
+    // retransmission, the following ones the packet injection rate.
+    // Each of them is a Bernoulli trial, so the cycles without shot
+    // before the next one are geometrically distributed.
+    if (after_shot) {
+	double por = shotProbability(cycle, false, shot_window_end);
+
+	if (rng.next() / (NOXIM_RAND_MAX + 1.0) < por) {
+	    shot_countdown = 0;
+	    shot_window_end = cycle + 1;
+	    return;
+	}
+
+	double pir = shotProbability(cycle + 1, true, shot_window_end);
+	int failures = geometric(pir);
+
+	shot_countdown = (failures < INT_MAX) ? failures + 1 : INT_MAX;
+    } else
+	shot_countdown =
+	    geometric(shotProbability(cycle, true, shot_window_end));
+}
+
+bool NoximProcessingElement::isIdle() const
+{
+    return !moved_flits && packet_queue.empty()
+	&& !transmittedAtPreviousCycle;
+}
+
+int NoximProcessingElement::idleCycles(const int limit) const
+{
+    if (NoximGlobalParams::traffic_distribution == TRAFFIC_TABLE_BASED
+	&& never_transmit)
+	return limit;
+
+    if (allPacketsSent())
+	return limit;
+
+    // canShot() draws again at the end of the window
+    double window = shot_window_end - getCurrentCycle();
+
+    if (window <= 0)
+	return 0;
+
+    return (int) min((double) min(shot_countdown, limit), window);
+}
+
+void NoximProcessingElement::skipIdleCycles(const int cycles)
+{
+    // The countdown is left alone once canShot() stops looking at it
+    shot_countdown -= min(cycles, shot_countdown);
+}
+
+void NoximProcessingElement::checkpoint(NoximCheckpoint & cp)
+{
+    cp.transfer(current_level_rx);
+    cp.transfer(current_level_tx);
+    cp.transfer(transmittedAtPreviousCycle);
+    cp.transfer(shot_countdown);
+    cp.transfer(shot_window_end);
+    cp.transfer(rng);
+    cp.transfer(moved_flits);
+    cp.transfer(packet_flits);
+
+    // The queue goes through a vector, oldest packet first
+    vector < NoximPacket > packets;
+
+    for (queue < NoximPacket > q = packet_queue; !q.empty(); q.pop())
+	packets.push_back(q.front());
+
+    cp.transfer(packets);
+
+    if (cp.isRestoring()) {
+	packet_queue = queue < NoximPacket > ();
+	for (unsigned int i = 0; i < packets.size(); i++)
+	    packet_queue.push(packets[i]);
+    }
 }
 
 void NoximProcessingElement::setUseLowVoltagePath(NoximPacket& packet)
 {
   if (NoximGlobalParams::qos < 1.0)
     {
-      double rnd = (double)rand() / (double)RAND_MAX;
+      double rnd = (double)rng.next() / (double)NOXIM_RAND_MAX;
 
       packet.use_low_voltage_path = (rnd >= NoximGlobalParams::qos);
       /*
@@ -199,7 +368,7 @@ NoximPacket NoximProcessingElement::trafficRandom()
 {
     NoximPacket p;
     p.src_id = local_id; 
-    double rnd = rand() / (double) RAND_MAX;
+    double rnd = rng.next() / (double) NOXIM_RAND_MAX;
     double range_start = 0.0;
 
     //cout << "\n " << sc_time_stamp().to_double()/1000 << " PE " << local_id << " rnd = " << rnd << endl;
@@ -248,14 +417,8 @@ NoximPacket NoximProcessingElement::trafficRandom()
 	}
     } while (p.dst_id == p.src_id);
 
-    p.timestamp = sc_time_stamp().to_double() / 1000;
+    p.timestamp = getCurrentCycle();
     p.size = p.flit_left = getRandomSize();
-    p.packet_id = PackedIndex;
-    PacketState.push_back(STATE_NOT_SENT);
-           cout<<"PE..ID"<<local_id<<",IndexID"<<PackedIndex<<endl;
-           
-            PackedIndex++;
-
     return p;
 }
 
@@ -273,7 +436,7 @@ NoximPacket NoximProcessingElement::trafficTranspose1()
     fixRanges(src, dst);
     p.dst_id = coord2Id(dst);
 
-    p.timestamp = sc_time_stamp().to_double() / 1000;
+    p.timestamp = getCurrentCycle();
     p.size = p.flit_left = getRandomSize();
 
     return p;
@@ -293,7 +456,7 @@ NoximPacket NoximProcessingElement::trafficTranspose2()
     fixRanges(src, dst);
     p.dst_id = coord2Id(dst);
 
-    p.timestamp = sc_time_stamp().to_double() / 1000;
+    p.timestamp = getCurrentCycle();
     p.size = p.flit_left = getRandomSize();
 
     return p;
@@ -337,7 +500,7 @@ NoximPacket NoximProcessingElement::trafficBitReversal()
     p.src_id = local_id;
     p.dst_id = dnode;
 
-    p.timestamp = sc_time_stamp().to_double() / 1000;
+    p.timestamp = getCurrentCycle();
     p.size = p.flit_left = getRandomSize();
 
     return p;
@@ -360,7 +523,7 @@ NoximPacket NoximProcessingElement::trafficShuffle()
     p.src_id = local_id;
     p.dst_id = dnode;
 
-    p.timestamp = sc_time_stamp().to_double() / 1000;
+    p.timestamp = getCurrentCycle();
     p.size = p.flit_left = getRandomSize();
 
     return p;
@@ -384,7 +547,7 @@ NoximPacket NoximProcessingElement::trafficButterfly()
     p.src_id = local_id;
     p.dst_id = dnode;
 
-    p.timestamp = sc_time_stamp().to_double() / 1000;
+    p.timestamp = getCurrentCycle();
     p.size = p.flit_left = getRandomSize();
 
     return p;
@@ -14,7 +14,13 @@
 #include <queue>
 #include <systemc.h>
 #include "NoximMain.h"
+#include "NoximPort.h"
+#include "NoximFlitArena.h"
+#include "NoximPacketRegistry.h"
+#include "NoximEventLog.h"
+#include "NoximPacketTrace.h"
 #include "NoximGlobalTrafficTable.h"
+#include "NoximCheckpoint.h"
 using namespace std;
 
 SC_MODULE(NoximProcessingElement)
@@ -22,17 +28,17 @@ SC_MODULE(NoximProcessingElement)
 
     // I/O Ports
     sc_in_clk clock;		// The input clock for the PE
-    sc_in < bool > reset;	// The reset signal for the PE
+    NoximIn < bool > reset;	// The reset signal for the PE
 
-    sc_in < NoximFlit > flit_rx;	// The input channel
-    sc_in < bool > req_rx;	// The request associated with the input channel
-    sc_out < bool > ack_rx;	// The outgoing ack signal associated with the input channel
+    NoximIn < NoximFlitHandle > flit_rx;	// The input channel
+    NoximIn < bool > req_rx;	// The request associated with the input channel
+    NoximOut < bool > ack_rx;	// The outgoing ack signal associated with the input channel
 
-    sc_out < NoximFlit > flit_tx;	// The output channel
-    sc_out < bool > req_tx;	// The request associated with the output channel
-    sc_in < bool > ack_tx;	// The outgoing ack signal associated with the output channel
+    NoximOut < NoximFlitHandle > flit_tx;	// The output channel
+    NoximOut < bool > req_tx;	// The request associated with the output channel
+    NoximIn < bool > ack_tx;	// The outgoing ack signal associated with the output channel
 
-    sc_in < int >free_slots_neighbor;
+    NoximIn < int >free_slots_neighbor;
 
     // Registers
     int local_id;		// Unique identification number
@@ -40,12 +46,21 @@ SC_MODULE(NoximProcessingElement)
     bool current_level_tx;	// Current level for Alternating Bit Protocol (ABP)
     queue < NoximPacket > packet_queue;	// Local queue of packets
     bool transmittedAtPreviousCycle;	// Used for distributions with memory
+    int shot_countdown;		// Cycles without shot before the next one
+    double shot_window_end;	// Cycle from which the countdown must be drawn again
+    NoximRandom rng;		// Random stream of the PE
+    bool moved_flits;		// A flit was received or sent in this cycle
 
     // Functions
     void rxProcess();		// The receiving process
     void txProcess();		// The transmitting process
+    void configure(const int _id, NoximGlobalTrafficTable * _traffic_table);	// Set the id and the initial state
     bool canShot(NoximPacket & packet);	// True when the packet must be shot
-    NoximFlit nextFlit();	// Take the next flit of the current packet
+    void scheduleShot(const double cycle, const bool after_shot);	// Draws shot_countdown from 'cycle' on
+    double shotProbability(const double cycle, const bool use_pir, double &window_end);	// Per-cycle shot probability, constant until window_end
+    int geometric(const double p);	// Cycles before a success of probability p
+    NoximFlitHandle nextFlit();	// Take the next flit of the current packet
+    NoximFlitHandle packet_flits;	// Arena block of the packet being sent
     NoximPacket trafficRandom();	// Random destination distribution
     NoximPacket trafficTranspose1();	// Transpose 1 destination distribution
     NoximPacket trafficTranspose2();	// Transpose 2 destination distribution
@@ -66,6 +81,14 @@ SC_MODULE(NoximProcessingElement)
     int getBit(int x, int w);
     double log2ceil(double x);
 
+    // Idle cycle fast-forward of the native engine
+    bool isIdle() const;	// Nothing moved or queued in the last cycle
+    int idleCycles(const int limit) const;	// Cycles before the next shot (at most limit)
+    void skipIdleCycles(const int cycles);	// Account cycles without a shot
+
+    // Saves the state of the PE between two cycles, or restores it
+    void checkpoint(NoximCheckpoint & cp);
+
     // Constructor
     SC_CTOR(NoximProcessingElement) {
 	SC_METHOD(rxProcess);
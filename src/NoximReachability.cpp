@@ -0,0 +1,221 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the static reachability analyzer
+ */
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <algorithm>
+#include "NoximReachability.h"
+
+NoximReachabilityCounts::NoximReachabilityCounts()
+{
+    pairs = 0;
+    delivered = 0;
+    no_path = 0;
+    loops = 0;
+    hops = 0;
+    stretch = 0.0;
+    max_hops = 0;
+    max_stretch = 0.0;
+    no_path_messages.assign(NFT_NO_PATH, 0);
+}
+
+void NoximReachabilityCounts::merge(const NoximReachabilityCounts & c)
+{
+    pairs += c.pairs;
+    delivered += c.delivered;
+    no_path += c.no_path;
+    loops += c.loops;
+    hops += c.hops;
+    stretch += c.stretch;
+    max_hops = max(max_hops, c.max_hops);
+    max_stretch = max(max_stretch, c.max_stretch);
+    for (unsigned int i = 0; i < no_path_messages.size(); i++)
+	no_path_messages[i] += c.no_path_messages[i];
+    lost.insert(lost.end(), c.lost.begin(), c.lost.end());
+}
+
+NoximReachability::NoximReachability(NoximNoC * _noc)
+{
+    noc = _noc;
+
+    int tiles = NoximGlobalParams::mesh_dim_x * NoximGlobalParams::mesh_dim_y;
+
+    masks.resize(tiles);
+    for (int x = 0; x < NoximGlobalParams::mesh_dim_x; x++)
+	for (int y = 0; y < NoximGlobalParams::mesh_dim_y; y++) {
+	    NoximRouter *r = noc->t[x][y]->r;
+	    masks[r->local_id] = r->CheckFaultNeighbor();
+	}
+
+    faulty.assign(tiles, false);
+    for (unsigned int i = 0; i < FaultRouter.size(); i++)
+	if (FaultRouter[i] >= 0 && FaultRouter[i] < tiles)
+	    faulty[FaultRouter[i]] = true;
+}
+
+int NoximReachability::walk(const int src, const int dst, int &hops,
+			    int &message) const
+{
+    static const int dx[DIRECTIONS] = { 0, 1, 0, -1 };
+    static const int dy[DIRECTIONS] = { -1, 0, 1, 0 };
+
+    NoximCoord current = id2Coord(src);
+    NoximCoord destination = id2Coord(dst);
+    int last_hop = DIRECTION_LOCAL;
+
+    // Past this many hops some router has been left twice with the same
+    // last hop: the packet goes round forever
+    int max_hops = (int) masks.size() * NFT_LAST_HOPS;
+
+    hops = 0;
+    message = 0;
+    for (int id = src; id != dst; id = coord2Id(current)) {
+	unsigned char entry = NegativeFirstTable.lookup(current, destination,
+							last_hop, masks[id]);
+
+	if (entry & NFT_NO_PATH) {
+	    message = entry & ~NFT_NO_PATH;
+	    return REACH_NO_PATH;
+	}
+
+	current.x += dx[entry];
+	current.y += dy[entry];
+	last_hop = entry;
+	hops++;
+
+	// Out of the mesh the packet is lost as well
+	if (hops > max_hops ||
+	    current.x < 0 || current.x >= NoximGlobalParams::mesh_dim_x ||
+	    current.y < 0 || current.y >= NoximGlobalParams::mesh_dim_y)
+	    return REACH_LOOP;
+    }
+
+    return REACH_DELIVERED;
+}
+
+void NoximReachability::analyzeSources(const int first, const int step,
+				       NoximReachabilityCounts & c) const
+{
+    int tiles = masks.size();
+
+    for (int src = first; src < tiles; src += step) {
+	if (faulty[src])
+	    continue;
+
+	NoximCoord s = id2Coord(src);
+
+	for (int dst = 0; dst < tiles; dst++) {
+	    if (dst == src || faulty[dst])
+		continue;
+
+	    int hops, message;
+	    int outcome = walk(src, dst, hops, message);
+
+	    c.pairs++;
+	    if (outcome == REACH_DELIVERED) {
+		NoximCoord d = id2Coord(dst);
+		int distance = abs(d.x - s.x) + abs(d.y - s.y);
+
+		c.delivered++;
+		c.hops += hops;
+		c.stretch += (double) hops / distance;
+		c.max_hops = max(c.max_hops, hops);
+		c.max_stretch = max(c.max_stretch, (double) hops / distance);
+		continue;
+	    }
+
+	    if (outcome == REACH_NO_PATH) {
+		c.no_path++;
+		c.no_path_messages[message]++;
+	    } else
+		c.loops++;
+	    c.lost.push_back(make_pair(src, dst));
+	}
+    }
+}
+
+// Arguments of a worker thread
+struct NoximReachabilityTask {
+    const NoximReachability *analyzer;
+    int first;
+    int step;
+    NoximReachabilityCounts counts;
+    pthread_t thread;
+};
+
+void *NoximReachability::worker(void *arg)
+{
+    NoximReachabilityTask & task = *(NoximReachabilityTask *) arg;
+
+    task.analyzer->analyzeSources(task.first, task.step, task.counts);
+    return NULL;
+}
+
+void NoximReachability::analyze(const int threads)
+{
+    int tiles = masks.size();
+    int n = max(1, min(threads, tiles));
+
+    // Sources dealt round robin, so that each thread gets some of every row
+    vector < NoximReachabilityTask > tasks(n);
+
+    for (int i = 0; i < n; i++) {
+	tasks[i].analyzer = this;
+	tasks[i].first = i;
+	tasks[i].step = n;
+    }
+
+    // The calling thread takes the first share
+    for (int i = 1; i < n; i++)
+	if (pthread_create(&tasks[i].thread, NULL, worker, &tasks[i]) != 0) {
+	    cerr << "Error: cannot create the analysis threads" << endl;
+	    exit(1);
+	}
+    analyzeSources(tasks[0].first, tasks[0].step, tasks[0].counts);
+
+    counts = NoximReachabilityCounts();
+    for (int i = 0; i < n; i++) {
+	if (i > 0)
+	    pthread_join(tasks[i].thread, NULL);
+	counts.merge(tasks[i].counts);
+    }
+    sort(counts.lost.begin(), counts.lost.end());
+}
+
+void NoximReachability::showReport(ostream & out) const
+{
+    out << "% Pairs of working routers: " << counts.pairs << endl;
+    out << "% Delivered pairs: " << counts.delivered << endl;
+    out << "% No path pairs: " << counts.no_path << endl;
+    out << "% Looping pairs: " << counts.loops << endl;
+    out << "% Reachability (delivered/pairs): " <<
+	(counts.pairs > 0 ? (double) counts.delivered / counts.pairs : 0.0)
+	<< endl;
+
+    if (counts.delivered > 0) {
+	out << "% Average path length (hops): " <<
+	    (double) counts.hops / counts.delivered << endl;
+	out << "% Max path length (hops): " << counts.max_hops << endl;
+	out << "% Average stretch (hops/Manhattan distance): " <<
+	    counts.stretch / counts.delivered << endl;
+	out << "% Max stretch (hops/Manhattan distance): " <<
+	    counts.max_stretch << endl;
+    }
+
+    for (unsigned int i = 0; i < counts.no_path_messages.size(); i++)
+	if (counts.no_path_messages[i] > 0)
+	    out << "% No path message " << i << ": " <<
+		counts.no_path_messages[i] << " pairs" << endl;
+
+    if (NoximGlobalParams::verbose_mode > VERBOSE_OFF)
+	for (unsigned int i = 0; i < counts.lost.size(); i++)
+	    out << "Not delivered: " << counts.lost[i].first << " -> " <<
+		counts.lost[i].second << endl;
+}
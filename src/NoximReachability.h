@@ -0,0 +1,79 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the static reachability analyzer
+ */
+
+#ifndef __NOXIMREACHABILITY_H__
+#define __NOXIMREACHABILITY_H__
+
+#include <iostream>
+#include <vector>
+#include <utility>
+#include "NoximMain.h"
+#include "NoximNoC.h"
+#include "NoximNegativeFirstTable.h"
+using namespace std;
+
+// Outcomes of the walk of a packet
+#define REACH_DELIVERED        0
+#define REACH_NO_PATH          1
+#define REACH_LOOP             2
+
+// NoximReachabilityCounts -- figures of the walks of a set of pairs
+struct NoximReachabilityCounts {
+    unsigned long pairs;
+    unsigned long delivered;
+    unsigned long no_path;
+    unsigned long loops;
+    unsigned long hops;		// Path lengths of the delivered pairs
+    double stretch;		// Path lengths over Manhattan distances, summed
+    int max_hops;
+    double max_stretch;		// Path length over Manhattan distance
+    vector < unsigned long >no_path_messages;	// By number of the message
+    vector < pair < int, int > >lost;	// Pairs not delivered
+
+    NoximReachabilityCounts();
+    void merge(const NoximReachabilityCounts & counts);
+};
+
+// NoximReachability -- follows the negative-first fault tolerant routing
+// hop by hop from every working router to every other working router of
+// an elaborated NoC, with the neighbor fault masks the routers have at
+// that moment. No flit is simulated: the path of a packet depends only
+// on the routing decisions, which are looked up in the compiled table.
+//
+// The sources are shared among threads, each walking the pairs of its
+// sources and keeping its own counts until the end.
+class NoximReachability {
+
+  public:
+
+    NoximReachability(NoximNoC * _noc);
+
+    // Walks every pair of working routers
+    void analyze(const int threads);
+
+    // Follows a packet from src to dst: returns the outcome, the hops
+    // taken and the number of the no path message (0 if none)
+    int walk(const int src, const int dst, int &hops, int &message) const;
+
+    void showReport(ostream & out) const;
+
+  private:
+
+    NoximNoC *noc;
+    vector < int >masks;	// Usable neighbors of each router
+    vector < bool >faulty;	// Faulty routers, by id
+    NoximReachabilityCounts counts;
+
+    void analyzeSources(const int first, const int step,
+			NoximReachabilityCounts & c) const;
+    static void *worker(void *arg);
+};
+
+#endif
@@ -73,3 +73,19 @@ void NoximReservationTable::invalidate(const int port_out)
 {
     rtable[port_out] = NOT_VALID;
 }
+
+void NoximReservationTable::getUsage(unsigned int &reserved,
+				     unsigned int &valid) const
+{
+    for (int i = 0; i < DIRECTIONS + 1; i++)
+	if (rtable[i] != NOT_VALID) {
+	    valid++;
+	    if (rtable[i] != NOT_RESERVED)
+		reserved++;
+	}
+}
+
+void NoximReservationTable::checkpoint(NoximCheckpoint & cp)
+{
+    cp.transfer(&rtable[0], DIRECTIONS + 1);
+}
@@ -13,6 +13,7 @@
 
 #include <cassert>
 #include "NoximMain.h"
+#include "NoximCheckpoint.h"
 using namespace std;
 
 class NoximReservationTable {
@@ -39,6 +40,13 @@ class NoximReservationTable {
     // Makes output port no longer available for reservation/release
     void invalidate(const int port_out);
 
+    // Adds the output ports connected to an input to 'reserved' and the
+    // valid ones to 'valid'
+    void getUsage(unsigned int &reserved, unsigned int &valid) const;
+
+    // Save the connections, or restore them
+    void checkpoint(NoximCheckpoint & cp);
+
   private:
 
      vector < int >rtable;	// reservation vector: rtable[i] gives the input
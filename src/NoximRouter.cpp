@@ -12,6 +12,8 @@
 
 void NoximRouter::rxProcess()
 {
+    moved_flits = false;
+
     if (reset.read()) {
 	// Clear outputs and indexes of receiving protocol
 	for (int i = 0; i < DIRECTIONS + 1; i++) {
@@ -20,6 +22,9 @@ void NoximRouter::rxProcess()
 	}
 	reservation_table.clear();
 	routed_flits = 0;
+	ejected_flits = 0;
+	ejected_packets = 0;
+	ejected_delay = 0.0;
 	local_drained = 0;
     } else {
 	// For each channel decide if a new flit can be accepted
@@ -35,15 +40,16 @@ void NoximRouter::rxProcess()
 
 	    if ((req_rx[i].read() == 1 - current_level_rx[i])
 		&& !buffer[i].IsFull()) {
-		NoximFlit received_flit = flit_rx[i].read();
+		NoximFlitHandle received_handle = flit_rx[i].read();
+		const NoximFlit & received_flit = FlitArena[received_handle];
 
 		if (NoximGlobalParams::verbose_mode > VERBOSE_OFF) {
-		    cout << sc_time_stamp().to_double() /
-			1000 << ": Router[" << local_id << "], Input[" << i
+		    console() << getCurrentCycle() << ": Router[" << local_id << "], Input[" << i
 			<< "], Received flit: " << received_flit << endl;
 		}
 		// Store the incoming flit in the circular buffer
-		buffer[i].Push(received_flit);
+		buffer[i].Push(received_handle);
+		moved_flits = true;
 
 		// Negate the old value for Alternating Bit Protocol (ABP)
 		current_level_rx[i] = 1 - current_level_rx[i];
@@ -80,7 +86,7 @@ void NoximRouter::txProcess()
 
 	  if (!buffer[i].IsEmpty()) 
 	    {
-	      NoximFlit flit = buffer[i].Front();
+	      const NoximFlit & flit = FlitArena[buffer[i].Front()];
 
 	      if (flit.flit_type == FLIT_TYPE_HEAD) 
 		{
@@ -94,25 +100,9 @@ void NoximRouter::txProcess()
 		  //cout<<"source"<<route_data.src_id<<endl;
 		   
 		  
-		  int o = route(route_data, flit);	
-
-		  
-			  if(i==DIRECTION_EAST)
-			  {EastBuffer = flit.FlitPath;}
-
-			  else if(i==DIRECTION_WEST)
-			  {WestBuffer = flit.FlitPath;}
-			  else if(i==DIRECTION_NORTH)
-			  {NorthBuffer = flit.FlitPath;}
-
-			  else if(i==DIRECTION_SOUTH)
-			  {SouthBuffer = flit.FlitPath;}
-
-			  else if(i==DIRECTION_LOCAL)
-			  {LocalBuffer = flit.FlitPath;}
-
-			  
-		  
+		  // Route a copy of the head: its path goes with every flit of the packet
+		  routed_head[i] = flit;
+		  int o = route(route_data, routed_head[i]);
 
 		  stats.power.Arbitration();
 
@@ -122,11 +112,11 @@ void NoximRouter::txProcess()
 		      reservation_table.reserve(i, o);
 		      if (NoximGlobalParams::verbose_mode > VERBOSE_OFF) 
 			{
-			  cout << sc_time_stamp().to_double() / 1000
+			  console() << getCurrentCycle()
 			       << ": Router[" << local_id
 			       << "], Input[" << i << "] (" << buffer[i].
 			    Size() << " flits)" << ", reserved Output["
-			       << o << "], flit: " << flit << endl;
+			       << o << "], flit: " << routed_head[i] << endl;
 			}
 		    }
 		}
@@ -139,42 +129,32 @@ void NoximRouter::txProcess()
 	{
 	  if (!buffer[i].IsEmpty()) 
 	    {
-	      NoximFlit flit = buffer[i].Front();
-
 	      int o = reservation_table.getOutputPort(i);
 	      if (o != NOT_RESERVED) 
 		{
 		  if (current_level_tx[o] == ack_tx[o].read()) 
 		    {
+		      NoximFlitHandle handle = buffer[i].Front();
+		      NoximFlit & flit = FlitArena[handle];
+
 		      if (NoximGlobalParams::verbose_mode > VERBOSE_OFF) 
 			{
-			  cout << sc_time_stamp().to_double() / 1000
+			  console() << getCurrentCycle()
 			       << ": Router[" << local_id
 			       << "], Input[" << i <<
 			    "] forward to Output[" << o << "], flit: "
 			       << flit << endl;
 			}
 
-			
-			  if(i==DIRECTION_EAST)
-			  {  flit.FlitPath=EastBuffer;}
-
-			  else if(i==DIRECTION_WEST)
-			  { flit.FlitPath=WestBuffer ;}
-			  else if(i==DIRECTION_NORTH)
-			  {  flit.FlitPath=NorthBuffer;}
-
-			  else if(i==DIRECTION_SOUTH)
-			  {  flit.FlitPath=SouthBuffer;}
-
-			  else if(i==DIRECTION_LOCAL)
-			  {  flit.FlitPath=LocalBuffer;}
-
-			  
-		      flit_tx[o].write(flit);
+		      flit.setPath(routed_head[i]);
+		      flit_tx[o].write(handle);
 		      current_level_tx[o] = 1 - current_level_tx[o];
 		      req_tx[o].write(current_level_tx[o]);
 		      buffer[i].Pop();
+		      moved_flits = true;
+
+		      if (PacketTrace.enabled())
+			traceFlit(flit, o);
 
 		      if (NoximGlobalParams::low_power_link_strategy)
 			{
@@ -189,12 +169,12 @@ void NoximRouter::txProcess()
 
 		      if (flit.dst_id == local_id){
 			stats.power.EndToEnd();
-			PacketState[flit.flit_id]=STATE_SUCCESS;
+			setPacketState(flit.flit_id, STATE_SUCCESS);
 			
 			//for(std::vector< int >::iterator it = flit.FlitPath.begin(); it != flit.FlitPath.end(); ++it)
             //std::cout<<"print path" << *it << endl;
 			
-			if(flit.flit_type==FLIT_TYPE_TAIL){ReceiveNumber++;}
+			if(flit.flit_type==FLIT_TYPE_TAIL){packetReceived();}
 			
 			}
 		      if (flit.flit_type == FLIT_TYPE_TAIL)
@@ -203,7 +183,7 @@ void NoximRouter::txProcess()
 			        {
 				   NoPath=false;
                                      //cout<<"flit_id.................NO PATH"<<flit.flit_id<<endl;
-				    PacketState[flit.flit_id]=STATE_NO_PATH;}
+				    setPacketState(flit.flit_id, STATE_NO_PATH);}
 
 		      // Update stats
 		      if (o == DIRECTION_LOCAL) 
@@ -215,25 +195,21 @@ void NoximRouter::txProcess()
 				 //   PacketState[flit.flit_id]=STATE_NO_PATH;
 				//}
 			    //else{
-			          stats.receivedFlit(sc_time_stamp().
-				   	            to_double() / 1000, flit);
+			          stats.receivedFlit(getCurrentCycle(), flit);
+			          ejected_flits++;
+			          if (flit.flit_type == FLIT_TYPE_HEAD) {
+				    ejected_packets++;
+				    ejected_delay += getCurrentCycle() - flit.timestamp;
+				  }
+			          if (flit.flit_type == FLIT_TYPE_TAIL)
+				    packetEjected(flit.flit_id);
                                       //cout<<"Router ID"<<local_id<<	","<<"flit_id.................SUCCESS"<<flit.flit_id<<endl;
                                       
                                  // PacketState[flit.flit_id]=STATE_SUCCESS;
 
 			          if (NoximGlobalParams::
 			                           max_volume_to_be_drained) 
-			          {
-			             if (drained_volume >=
-				         NoximGlobalParams::
-				           max_volume_to_be_drained)
-				          sc_stop();
-			             else 
-				     {
-				       drained_volume++;
-				       local_drained++;
-				     }
-			          }
+				    flitDrained();
 			        //}
 		        } 
 		      else if (i != DIRECTION_LOCAL) 
@@ -285,11 +261,15 @@ void NoximRouter::bufferMonitor()
 	    for (int i = 0; i < DIRECTIONS; i++)
 		NoP_data_out[i].write(current_NoP_data);
 	}
+
+	if (NoximGlobalParams::show_buffer_stats)
+	    for (int i = 0; i < DIRECTIONS + 1; i++)
+		buffer[i].SampleOccupancy();
     }
 }
 
 vector <
-    int >NoximRouter::routingFunction(const NoximRouteData & route_data, NoximFlit flit)
+    int >NoximRouter::routingFunction(const NoximRouteData & route_data, const NoximFlit & flit)
 {
     NoximCoord position = id2Coord(route_data.current_id);
     NoximCoord src_coord = id2Coord(route_data.src_id);
@@ -342,7 +322,7 @@ int NoximRouter::route(const NoximRouteData & route_data, NoximFlit &flit)
 
 	int result = candidate_channels[0];
 
-	flit.FlitPath.push_back(result);
+	flit.pushHop(result);
 
     return selectionFunction(candidate_channels, route_data);
 }
@@ -350,13 +330,12 @@ int NoximRouter::route(const NoximRouteData & route_data, NoximFlit &flit)
 void NoximRouter::NoP_report() const
 {
     NoximNoP_data NoP_tmp;
-    cout << sc_time_stamp().to_double() /
-	1000 << ": Router[" << local_id << "] NoP report: " << endl;
+    console() << getCurrentCycle() << ": Router[" << local_id << "] NoP report: " << endl;
 
     for (int i = 0; i < DIRECTIONS; i++) {
 	NoP_tmp = NoP_data_in[i].read();
 	if (NoP_tmp.sender_id != NOT_VALID)
-	    cout << NoP_tmp;
+	    console() << NoP_tmp;
     }
 }
 
@@ -434,7 +413,7 @@ int NoximRouter::selectionNoP(const vector < int >&directions,
 	    equivalent_directions.push_back(directions[i]);
 
     direction_selected =
-	equivalent_directions[rand() % equivalent_directions.size()];
+	equivalent_directions[rng.next() % equivalent_directions.size()];
 
     return direction_selected;
 }
@@ -457,9 +436,9 @@ int NoximRouter::selectionBufferLevel(const vector < int >&directions)
     }
 
     if (best_dirs.size())
-	return (best_dirs[rand() % best_dirs.size()]);
+	return (best_dirs[rng.next() % best_dirs.size()]);
     else
-	return (directions[rand() % directions.size()]);
+	return (directions[rng.next() % directions.size()]);
 
     //-------------------------
     // TODO: unfair if multiple directions have same buffer level
@@ -503,10 +482,10 @@ int NoximRouter::selectionBufferLevel(const vector < int >&directions)
 int NoximRouter::selectionRandom(const vector < int >&directions)
 {
     //cout<<"-----------------------------------------------------------------"<<endl;
-    if(directions.size()==0){cout<<"radom 0"<<endl;}
+    if(directions.size()==0){console()<<"radom 0"<<endl;}
     int output;
-    int random= directions[rand() % directions.size()];
-    int Fault= CheckFaultNeighbor(local_id);
+    int random= directions[rng.next() % directions.size()];
+    int Fault= CheckFaultNeighbor();
     //cout<<"Fault1"<<Fault<<endl;
     int temp1=Fault;
     int temp2=Fault;
@@ -539,16 +518,16 @@ int NoximRouter::selectionFunction(const vector < int >&directions,
  	if (directions.size() == 1)
 	   { 
              int output;
-        int Fault=CheckFaultNeighbor(local_id);
+        int Fault=CheckFaultNeighbor();
 //cout<<"Fault2"<<Fault<<endl;
 	    int temp1=Fault;
         int temp2=Fault;
         int temp3=Fault;
         int temp4=Fault;
-        if((directions[0]==DIRECTION_EAST)&&((temp1&8)==0)){NoPath=true; output=DIRECTION_LOCAL;cout<<"FAILLLLLL2"<<endl;}
-        else if((directions[0]==DIRECTION_NORTH)&&((temp2&4)==0)){NoPath=true; output=DIRECTION_LOCAL;cout<<"FAILLLLLL3"<<endl;}
-        else if((directions[0]==DIRECTION_WEST)&&((temp3&2)==0)){NoPath=true; output=DIRECTION_LOCAL;cout<<"FAILLLLLL4"<<endl;}
-        else if((directions[0]==DIRECTION_SOUTH)&&((temp4&1)==0)){NoPath=true; output=DIRECTION_LOCAL;cout<<"FAILLLLLL5"<<endl;}
+        if((directions[0]==DIRECTION_EAST)&&((temp1&8)==0)){NoPath=true; output=DIRECTION_LOCAL;console()<<"FAILLLLLL2"<<endl;}
+        else if((directions[0]==DIRECTION_NORTH)&&((temp2&4)==0)){NoPath=true; output=DIRECTION_LOCAL;console()<<"FAILLLLLL3"<<endl;}
+        else if((directions[0]==DIRECTION_WEST)&&((temp3&2)==0)){NoPath=true; output=DIRECTION_LOCAL;console()<<"FAILLLLLL4"<<endl;}
+        else if((directions[0]==DIRECTION_SOUTH)&&((temp4&1)==0)){NoPath=true; output=DIRECTION_LOCAL;console()<<"FAILLLLLL5"<<endl;}
         else{output=directions[0];}
         //cout<<"DIRECTION2"<<output<<endl;
 	return output;
@@ -634,9 +613,9 @@ vector < int >NoximRouter::routingNegativeFirst(const NoximCoord & current,
 						const NoximCoord &
 						destination)
 {
-    cout<<"id"<<local_id<<endl;
+    console()<<"id"<<local_id<<endl;
     vector < int >directions;
-    cout<<"destination"<<coord2Id(destination)<<endl;
+    console()<<"destination"<<coord2Id(destination)<<endl;
     if ((destination.x <= current.x && destination.y <= current.y) ||
 	(destination.x >= current.x && destination.y >= current.y))
 	return routingXY(current, destination);
@@ -700,10 +679,10 @@ vector < int >NoximRouter::routingOddEven(const NoximCoord & current,
     }
 
     if (!(directions.size() > 0 && directions.size() <= 2)) {
-	cout << "\n PICCININI, CECCONI & ... :";	// STAMPACCHIA
-	cout << source << endl;
-	cout << destination << endl;
-	cout << current << endl;
+	console() << "\n PICCININI, CECCONI & ... :";	// STAMPACCHIA
+	console() << source << endl;
+	console() << destination << endl;
+	console() << current << endl;
 
     }
     assert(directions.size() > 0 && directions.size() <= 2);
@@ -761,7 +740,7 @@ vector < int >NoximRouter::routingTableBased(const int dir_in,
 	routing_table.getAdmissibleOutputs(dir_in, coord2Id(destination));
 
     if (ao.size() == 0) {
-	cout << "dir: " << dir_in << ", (" << current.x << "," << current.
+	console() << "dir: " << dir_in << ", (" << current.x << "," << current.
 	    y << ") --> " << "(" << destination.x << "," << destination.
 	    y << ")" << endl << coord2Id(current) << "->" <<
 	    coord2Id(destination) << endl;
@@ -784,436 +763,181 @@ vector < int >NoximRouter::routingTableBased(const int dir_in,
 }
 
 vector < int >NoximRouter::routingNegativeFirstFaultTolerance(const NoximCoord & current,
-				                     const NoximCoord & destination,NoximFlit flit)
+				                     const NoximCoord & destination, const NoximFlit & flit)
 {
-	
-	vector < int >directions;
-	//directions.push_back(DIRECTION_LOCAL);
-
-	int Fault= CheckFaultNeighbor(local_id);
-	//for (int i=0;i<flit.FlitPath[flit.FlitPath.size()];i++){cout<<"Path"<<i<<"is"<<flit.FlitPath[i]<<endl;}
-	//cout<<"Path"<<flit.FlitPath<<endl;
-	//cout<<"fault condition"<<Fault<<endl;
-	//cout<<"id"<<local_id<<endl;
-	//cout<<"destination"<<coord2Id(destination)<<endl;
-	if(destination.x > current.x && destination.y < current.y)  // if des in NE direction
-	{
-		//cout<<"NE"<<endl;
-		Fault=(Fault>>2);
-		if(Fault==3)
-		{
-		  if(flit.FlitPath[flit.FlitPath.size()-1]==DIRECTION_WEST) {directions.push_back(DIRECTION_NORTH);}
-		  else if(flit.FlitPath[flit.FlitPath.size()-1]==DIRECTION_SOUTH) {directions.push_back(DIRECTION_EAST);}
-          else {
-			  if(abs(destination.x - current.x) >= abs (destination.y - current.y)){directions.push_back(DIRECTION_EAST);}
-			  else{directions.push_back(DIRECTION_NORTH);}
-			  /*
-			 if((CheckFaultNeighbor(getNeighborId(local_id, DIRECTION_EAST))&4)==4)
-			 {
-				if(abs(destination.x - current.x) >= abs (destination.y - current.y)) {directions.push_back(DIRECTION_EAST);}
-				else {directions.push_back(DIRECTION_NORTH);}
-			 }
-			 else if((CheckFaultNeighbor(getNeighborId(local_id, DIRECTION_NORTH))&4)==4){directions.push_back(DIRECTION_NORTH);}
-			 else if((CheckFaultNeighbor(getNeighborId(local_id, DIRECTION_EAST))&8)==8){directions.push_back(DIRECTION_EAST);}
-			 else {directions.push_back(DIRECTION_LOCAL); NoPath=true;   cout<<"NoPath------------1"<<endl;}
-		       }*/
-		  }   
-		}
-		else if(Fault==2)
-		{
-		  //if(flit.FlitPath[flit.FlitPath.size()-1]==DIRECTION_WEST){directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------2"<<endl;}
-		   {directions.push_back(DIRECTION_EAST);}
-		}
-		else if(Fault==1)
-		{
-		  //if(flit.FlitPath[flit.FlitPath.size()-1]==DIRECTION_SOUTH){directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------3"<<endl;}
-		   {directions.push_back(DIRECTION_NORTH);}
-		}
-		else {directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------4"<<endl;}	
-	}
-	else if(destination.x < current.x && destination.y < current.y)  // if des in NW direction
-	{
-		//cout<<"NW"<<endl;
-		if(current.x-destination.x==1)
-		{
-		   if(flit.FlitPath[flit.FlitPath.size()-1]==DIRECTION_EAST)
-		   {
-			if((Fault&4)==4){directions.push_back(DIRECTION_NORTH);}
-			else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------5"<<endl;}
-		   }
-		   else if(flit.FlitPath[flit.FlitPath.size()-1]==DIRECTION_NORTH)
-		   {
-			int temp=Fault;
-			if((Fault&2)==2){directions.push_back(DIRECTION_WEST);}
-			else if((temp&4)==4){directions.push_back(DIRECTION_NORTH);}
-			else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------6"<<endl;}
-		   }
-		   else
-		   {
-			   int temp1=Fault;
-			   int temp2=Fault;
-			if((Fault&2)==2){directions.push_back(DIRECTION_WEST);}
-			else{
-				if((temp2&1)==1){directions.push_back(DIRECTION_SOUTH);}
-				else{
-				if(current.y==NoximGlobalParams::mesh_dim_y-1){
-					if((temp1&4)==4){directions.push_back(DIRECTION_NORTH);}
-					else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------60"<<endl;}
-				}
-			    else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------7"<<endl;}
-				}	
-	           }
-		   }   
-		}
-		
-		else if(current.y-destination.y==1)
-		{
-		   if(flit.FlitPath[flit.FlitPath.size()-1]==DIRECTION_SOUTH)
-		   {
-			   int temp3=Fault;
-			if((Fault&2)==2){directions.push_back(DIRECTION_WEST);}
-			else{
-				if((temp3&1)==1){directions.push_back(DIRECTION_SOUTH);}
-				else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------8"<<endl;}
-			    }
-		   }
-		   /*
-		   else if(flit.FlitPath[flit.FlitPath.size()-1]==DIRECTION_WEST)
-		   {
-			int temp=Fault;
-			if((Fault&4)==4){directions.push_back(DIRECTION_NORTH);}
-			else if((temp&2)==2){directions.push_back(DIRECTION_WEST);}
-			else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------9"<<endl;}
-		   }*/
-		   else
-		   {
-			   int temp1=Fault;
-			   int temp2=Fault;
-			if((Fault&2)==2){directions.push_back(DIRECTION_WEST);}
-			else{
-				if((temp2&1)==1){directions.push_back(DIRECTION_SOUTH);}
-				else{
-				if(current.y==NoximGlobalParams::mesh_dim_y-1){
-					if((temp1&4)==4){directions.push_back(DIRECTION_NORTH);}
-					else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------61"<<endl;}
-				}
-			    else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------10"<<endl;}
-				}	
-	           }
-		   }   
-		}
-		/*   
-		else{
-			int temp=Fault;
-			int temp2=Fault;
-		  if((Fault&2)==0)
-		  {
-		    //if(flit.FlitPath[flit.FlitPath.size()-1]==DIRECTION_SOUTH){directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------11"<<endl;}
-		    else{directions.push_back(DIRECTION_SOUTH);}
-		  }
-		  else {directions.push_back(DIRECTION_WEST);}
-		}
-        */
-		else
-		{
-			int temp=Fault;
-			int temp2=Fault;
-		  if((Fault&2)==0)
-		  {
-		    //if(flit.FlitPath[flit.FlitPath.size()-1]==DIRECTION_WEST){directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------18"<<endl;}
-			if((temp&1)==0)
-			{
-				if(current.y==NoximGlobalParams::mesh_dim_y-1){
-					if((temp2&4)==4){directions.push_back(DIRECTION_NORTH);}
-					else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------64"<<endl;}
-				}
-				else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------65"<<endl;}
-			}
-		    else{directions.push_back(DIRECTION_SOUTH);}
-		  }
-		  else {directions.push_back(DIRECTION_WEST);}
-		}
-		
-	}
-	else if(destination.x > current.x && destination.y > current.y) // if des in SE direction
-	{
-		//cout<<"SE"<<endl;
-		if(destination.x - current.x==1)
-		{
-		   if(flit.FlitPath[flit.FlitPath.size()-1]==DIRECTION_WEST)
-		   {
-			   int temp3=Fault;
-			if((Fault&1)==1){directions.push_back(DIRECTION_SOUTH);}
-			else{
-				if((temp3&2)==2){directions.push_back(DIRECTION_WEST);}
-				else{
-				directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------12"<<endl;}
-			    }
-		    }
-		   /*
-		   else if(flit.FlitPath[flit.FlitPath.size()-1]==DIRECTION_SOUTH)
-		   {
-			int temp=Fault;
-			if((Fault&8)==8){directions.push_back(DIRECTION_EAST);}
-			else if((temp&1)==1){directions.push_back(DIRECTION_SOUTH);}
-			else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------13"<<endl;}
-		   }*/
-		   else
-		   {
-			   int temp1=Fault;
-			   int temp2=Fault;
-			if((Fault&1)==1){directions.push_back(DIRECTION_SOUTH);}
-			else{ 
-			if((temp2&2)==2){directions.push_back(DIRECTION_WEST);}
-			else{
-				if(current.x==0){
-					if((temp1&8)==8){directions.push_back(DIRECTION_EAST);}
-					else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------52"<<endl;}
-				}
-				else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------53"<<endl;}
-			}
-		   }
-		}
-		}
-		
-		else if(destination.y - current.y==1)
-		{
-		   if(flit.FlitPath[flit.FlitPath.size()-1]==DIRECTION_NORTH)
-		   {
-			if((Fault&8)==8){directions.push_back(DIRECTION_EAST);}
-			else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------15"<<endl;}
-		   }
-		   else if(flit.FlitPath[flit.FlitPath.size()-1]==DIRECTION_EAST)
-		   {
-			int temp=Fault;
-			if((Fault&1)==1){directions.push_back(DIRECTION_SOUTH);}
-			else if((temp&8)==8){directions.push_back(DIRECTION_EAST);}
-			else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------16"<<endl;}
-		   }
-		   else
-		   {	int temp1=Fault;
-			   int temp2=Fault;
-			if((Fault&1)==1){directions.push_back(DIRECTION_SOUTH);}
-            else{
-				
-			if((temp2&2)==2){directions.push_back(DIRECTION_WEST);}
-			else{
-				if(current.x==0){
-					if((temp1&8)==8){directions.push_back(DIRECTION_EAST);}
-					else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------54"<<endl;}
-				}
-				else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------55"<<endl;}
-			}
-		   }
-		   }   
-		}
+    vector < int >directions;
+    unsigned char entry =
+	NegativeFirstTable.lookup(current, destination, flit.lastHop(),
+				  CheckFaultNeighbor());
 
-		else
-		{
-			int temp=Fault;
-			int temp2=Fault;
-		  if((Fault&1)==0)
-		  {
-		    //if(flit.FlitPath[flit.FlitPath.size()-1]==DIRECTION_WEST){directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------18"<<endl;}
-			if((temp&2)==0)
-			{
-				if(current.x==0){
-					if((temp2&8)==8){directions.push_back(DIRECTION_EAST);}
-					else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------50"<<endl;}
-				}
-				else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------51"<<endl;}
-			}
-		    else{directions.push_back(DIRECTION_WEST);}
-		  }
-		  else {directions.push_back(DIRECTION_SOUTH);}
-		}
-	}
-	else if(destination.x < current.x && destination.y > current.y)  // if des in SW direction
-	{
-		//cout<<"SW"<<endl;
-		Fault=(Fault&3);
-		if(Fault==3)
-		{
-		  if(flit.FlitPath[flit.FlitPath.size()-1]==DIRECTION_EAST) {directions.push_back(DIRECTION_SOUTH);}
-		  else if(flit.FlitPath[flit.FlitPath.size()-1]==DIRECTION_NORTH) {directions.push_back(DIRECTION_WEST);}
-          else {
-					  if(abs(destination.x - current.x) >= abs (destination.y - current.y)) {directions.push_back(DIRECTION_WEST); }
-				    else {directions.push_back(DIRECTION_SOUTH);}
-					  
-					  
-					  /*
-			 if((CheckFaultNeighbor(getNeighborId(local_id, DIRECTION_WEST))&1)==1)
-			 {
-				
-				if(abs(destination.x - current.x) >= abs (destination.y - current.y)) {directions.push_back(DIRECTION_WEST); }
-				else {directions.push_back(DIRECTION_SOUTH);}
-			 }
-			 else if((CheckFaultNeighbor(getNeighborId(local_id, DIRECTION_SOUTH))&1)==1){directions.push_back(DIRECTION_SOUTH);}
-			 else if((CheckFaultNeighbor(getNeighborId(local_id, DIRECTION_WEST))&2)==2){directions.push_back(DIRECTION_WEST);}
-			 else {directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------19"<<endl;}
-		       }*/
-		      }
-		}
-		else if(Fault==2)
-		{
-		  if(flit.FlitPath[flit.FlitPath.size()-1]==DIRECTION_EAST){directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------20"<<endl;}
-		  else {directions.push_back(DIRECTION_WEST);}
-		}
-		else if(Fault==1)
-		{
-		  if(flit.FlitPath[flit.FlitPath.size()-1]==DIRECTION_NORTH){directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------21"<<endl;}
-		  else {directions.push_back(DIRECTION_SOUTH);}
-		}
-		else {directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------22"<<endl;}	
-	}
-	
-	else if(destination.x == current.x && destination.y < current.y)  // if des in N direction
-	{
-		//cout<<"N"<<endl;
-	   int temp = Fault;
-	   int temp2=Fault;
-	   int temp3=Fault;
-	   int temp4=Fault;
-	   if((getNeighborId(local_id, DIRECTION_NORTH)==flit.dst_id)&&(temp3&4)==4){directions.push_back(DIRECTION_NORTH);}
-	   else if((temp2&2)==2){
-		   if((flit.FlitPath[flit.FlitPath.size()-1]!=DIRECTION_EAST)&&(flit.FlitPath[flit.FlitPath.size()-1]!=DIRECTION_NORTH))
-		   {directions.push_back(DIRECTION_WEST);}
-		   else if((temp4&4)==4)
-           {
-		      directions.push_back(DIRECTION_NORTH);
-           }
-		   else {directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------70"<<endl;}
-		   }
-	   else if((temp&4)==4)
-           {
-		      directions.push_back(DIRECTION_NORTH);
-           }
-	   else if(destination.x==0)
-		{
-		   if((Fault&8)==8){directions.push_back(DIRECTION_EAST);}
-		   else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------24"<<endl;}
-		}
-	   else	if(destination.x==NoximGlobalParams::mesh_dim_x-1)
-		{
-		   if((Fault&2)==2){directions.push_back(DIRECTION_WEST);}
-		   else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------23"<<endl;}
-		}
-		else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------25"<<endl;}
-        
-		  
-		
-		 	
-	}
+    if (entry & NFT_NO_PATH) {
+	directions.push_back(DIRECTION_LOCAL);
+	NoPath = true;
+	logNoPath(entry & ~NFT_NO_PATH);
+    } else
+	directions.push_back(entry);
 
-	else if(destination.x == current.x && destination.y > current.y)  // if des in S direction
-	{
-		//cout<<"S"<<endl;
-	   int temp = Fault;
-	   int temp2=Fault;
-	   int temp3=Fault;
-	  // int temp4=Fault;
-	   if((getNeighborId(local_id, DIRECTION_SOUTH)==flit.dst_id)&&(temp3&1)==1){directions.push_back(DIRECTION_SOUTH);}
-	   //else if((temp2&2)==2){directions.push_back(DIRECTION_WEST);}
-	   
-	   else if((temp&1)==1)
-           {
-		directions.push_back(DIRECTION_SOUTH);
-           }
-		else if((temp2&2)==2){directions.push_back(DIRECTION_WEST);}
-		else if(destination.x==0)
-		{
-		   if((Fault&8)==8){directions.push_back(DIRECTION_EAST);}
-		   else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------45"<<endl;}
-		}
-	   else if(destination.x==NoximGlobalParams::mesh_dim_x-1)
-		{
-		   if((Fault&2)==2){directions.push_back(DIRECTION_WEST);}
-		   else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------44"<<endl;}
-		}
-		
-		else{directions.push_back(DIRECTION_LOCAL);NoPath=true; cout<<"NoPath------------46"<<endl;}
-           
-	    
-	  
-		   
-	     	
-	}
+    return directions;
+}
 
-	else if(destination.x > current.x && destination.y == current.y)  // if des in E direction
-	{
-		//cout<<"E"<<endl;
-	   int temp = Fault;
-	   int temp2=Fault;
-	   int temp3=Fault;
-	   int temp4=Fault;
-	   if((getNeighborId(local_id, DIRECTION_EAST)==flit.dst_id)&&(temp3&8)==8){directions.push_back(DIRECTION_EAST);}
-	   else if((temp2&1)==1){
-		   if((flit.FlitPath[flit.FlitPath.size()-1]!=DIRECTION_EAST)&&(flit.FlitPath[flit.FlitPath.size()-1]!=DIRECTION_NORTH))
-		   {directions.push_back(DIRECTION_SOUTH);}
-		   else if((temp4&8)==8)
-            {
-		     directions.push_back(DIRECTION_EAST);
-            }
-			else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------71"<<endl;}
-		   }
-	    else if((temp&8)==8)
-            {
-		     directions.push_back(DIRECTION_EAST);
-            }
-	         else if(destination.y==NoximGlobalParams::mesh_dim_y-1)
-		       {
-		         if((Fault&4)==4){directions.push_back(DIRECTION_NORTH);}
-		         else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------29"<<endl;}
-		       }
-		      else if(destination.y==0)
-		      {
-		         if((Fault&1)==1){directions.push_back(DIRECTION_SOUTH);}
-		         else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------30"<<endl;}
-		      }
-		    else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------31"<<endl;}
-           
-	      
-		
-		
-	      	
-	}
+ostream & NoximRouter::console() const
+{
+    if (defer_globals)
+	return deferred_output;
+    return cout;
+}
 
-	else if(destination.x < current.x && destination.y == current.y)  // if des in W direction
-	{
-		//cout<<"W"<<endl;
-	   int temp = Fault;
-	   int temp2=Fault;
-	   int temp3=Fault;
-	   if((getNeighborId(local_id, DIRECTION_WEST)==flit.dst_id)&&(temp3&2)==2){directions.push_back(DIRECTION_WEST);}
-	 //else if((temp2&1)==1){directions.push_back(DIRECTION_SOUTH);}
-
-	   else if((temp&2)==2)
-           {
-		directions.push_back(DIRECTION_WEST);
-           }
-		else if((temp2&1)==1){directions.push_back(DIRECTION_SOUTH);}
-
-	   else	if(destination.y==NoximGlobalParams::mesh_dim_y-1)
-		{
-		   if((Fault&4)==4){directions.push_back(DIRECTION_NORTH);}
-		   else{directions.push_back(DIRECTION_LOCAL);NoPath=true; cout<<"NoPath------------32"<<endl;}
-		}
-		else if(destination.y==0)
-		{
-		   if((Fault&1)==1){directions.push_back(DIRECTION_SOUTH);}
-		   else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------33"<<endl;}
-		}
-		else{directions.push_back(DIRECTION_LOCAL);NoPath=true;  cout<<"NoPath------------34"<<endl;}
-           
-	   
-	  
-	     	
+void NoximRouter::setPacketState(const int packet_id, const int state)
+{
+    if (defer_globals) {
+	NoximDeferredUpdate update = { DEFERRED_PACKET_STATE, packet_id, state };
+	deferred.push_back(update);
+    } else
+	PacketRegistry.setState(packet_id, state);
+}
+
+void NoximRouter::packetReceived()
+{
+    if (defer_globals) {
+	NoximDeferredUpdate update = { DEFERRED_PACKET_RECEIVED, 0, 0 };
+	deferred.push_back(update);
+    } else
+	ReceiveNumber++;
+}
+
+void NoximRouter::packetEjected(const int packet_id)
+{
+    if (defer_globals) {
+	NoximDeferredUpdate update = { DEFERRED_PACKET_EJECTED, packet_id, 0 };
+	deferred.push_back(update);
+    } else
+	PacketRegistry.setEjected(packet_id);
+}
+
+void NoximRouter::logNoPath(const int message)
+{
+    if (!EventLog.enabled(LOG_ROUTING))
+	return;
+
+    if (defer_globals) {
+	NoximDeferredUpdate update = { DEFERRED_NO_PATH, 0, message };
+	deferred.push_back(update);
+    } else
+	EventLog.write(LOG_ROUTING, (unsigned int) getCurrentCycle(),
+		       EVENT_NO_PATH, local_id, message);
+}
+
+void NoximRouter::traceFlit(const NoximFlit & flit, const int output)
+{
+    NoximTraceRecord record;
+
+    record.cycle = (unsigned int) getCurrentCycle();
+    record.packet_id = flit.flit_id;
+    record.router = local_id;
+    record.direction = output;
+    record.value = 0;
+
+    if (flit.flit_type == FLIT_TYPE_HEAD) {
+	if (output != DIRECTION_LOCAL)
+	    record.type = TRACE_HOP;
+	else if (flit.dst_id == local_id)
+	    record.type = TRACE_DELIVER;
+	else
+	    record.type = TRACE_NO_PATH;
+    } else if (flit.flit_type == FLIT_TYPE_TAIL && output == DIRECTION_LOCAL)
+	record.type = TRACE_EJECT;
+    else
+	return;
+
+    if (defer_globals)
+	deferred_trace.push_back(record);
+    else
+	PacketTrace.append(record);
+}
+
+void NoximRouter::flitDrained()
+{
+    if (defer_globals) {
+	NoximDeferredUpdate update = { DEFERRED_FLIT_DRAINED, 0, 0 };
+	deferred.push_back(update);
+    } else if (drained_volume >= NoximGlobalParams::max_volume_to_be_drained)
+	stopSimulation();
+    else {
+	drained_volume++;
+	local_drained++;
+    }
+}
+
+void NoximRouter::setDeferGlobals(const bool defer)
+{
+    commitDeferred();
+    defer_globals = defer;
+}
+
+void NoximRouter::commitDeferred()
+{
+    bool defer = defer_globals;
+
+    defer_globals = false;
+    for (unsigned int i = 0; i < deferred.size(); i++) {
+	switch (deferred[i].type) {
+	case DEFERRED_PACKET_STATE:
+	    setPacketState(deferred[i].packet_id, deferred[i].state);
+	    break;
+	case DEFERRED_PACKET_RECEIVED:
+	    packetReceived();
+	    break;
+	case DEFERRED_FLIT_DRAINED:
+	    flitDrained();
+	    break;
+	case DEFERRED_PACKET_EJECTED:
+	    packetEjected(deferred[i].packet_id);
+	    break;
+	case DEFERRED_NO_PATH:
+	    logNoPath(deferred[i].state);
+	    break;
 	}
-	else{directions.push_back(DIRECTION_LOCAL);}
-	//cout<<"OUTPUT........................................................"<<directions[0]<<endl;
-	
-	return directions;
+    }
+    deferred.clear();
+    for (unsigned int i = 0; i < deferred_trace.size(); i++)
+	PacketTrace.append(deferred_trace[i]);
+    deferred_trace.clear();
+    defer_globals = defer;
+
+    if (deferred_output.tellp() > 0) {
+	cout << deferred_output.str();
+	deferred_output.str("");
+    }
+}
 
+bool NoximRouter::isIdle() const
+{
+    if (moved_flits)
+	return false;
+
+    for (int i = 0; i < DIRECTIONS + 1; i++)
+	if (!buffer[i].IsEmpty())
+	    return false;
+
+    return true;
+}
+
+void NoximRouter::skipIdleCycles(const int cycles)
+{
+    // What rxProcess(), txProcess() and bufferMonitor() would do with
+    // empty buffers and no incoming request
+    start_from_port += cycles;
+    stats.power.Leakage(2 * (unsigned long) cycles);
+
+    if (NoximGlobalParams::show_buffer_stats)
+	for (int i = 0; i < DIRECTIONS + 1; i++)
+	    buffer[i].SampleOccupancy(cycles);
+}
+
+void NoximRouter::skipResetCycles(const int cycles)
+{
+    // rxProcess() and txProcess() under reset only account the leakage
+    stats.power.Leakage(2 * (unsigned long) cycles);
 }
 
 void NoximRouter::configure(const int _id,
@@ -1226,12 +950,22 @@ void NoximRouter::configure(const int _id,
 
     start_from_port = DIRECTION_LOCAL;
     NoPath=false;
+    moved_flits = false;
+    defer_globals = false;
+    rng.seed(NoximGlobalParams::rnd_generator_seed, 2 * _id);
 
     if (grt.isValid())
 	routing_table.configure(grt, _id);
 
-    for (int i = 0; i < DIRECTIONS + 1; i++)
+    deferred.clear();
+    deferred_trace.clear();
+    deferred_output.str("");
+
+    for (int i = 0; i < DIRECTIONS + 1; i++) {
 	buffer[i].SetMaxBufferSize(_max_buffer_size);
+	buffer[i].ResetStats();
+	routed_head[i] = NoximFlit();
+    }
 
     int row = _id / NoximGlobalParams::mesh_dim_x;
     int col = _id % NoximGlobalParams::mesh_dim_x;
@@ -1243,6 +977,14 @@ void NoximRouter::configure(const int _id,
       buffer[DIRECTION_WEST].Disable();
     if (col == NoximGlobalParams::mesh_dim_x-1)
       buffer[DIRECTION_EAST].Disable();
+
+    // Faults are set by the NoC once all the routers exist
+    border_mask = 0;
+    neighbor_faults = 0;
+    link_faults = 0;
+    for (int i = 0; i < DIRECTIONS; i++)
+	if (getNeighborId(_id, i) != NOT_VALID)
+	    border_mask |= faultBit(i);
 }
 
 unsigned long NoximRouter::getRoutedFlits()
@@ -1250,6 +992,21 @@ unsigned long NoximRouter::getRoutedFlits()
     return routed_flits;
 }
 
+unsigned long NoximRouter::getEjectedFlits()
+{
+    return ejected_flits;
+}
+
+unsigned long NoximRouter::getEjectedPackets()
+{
+    return ejected_packets;
+}
+
+double NoximRouter::getEjectedDelay()
+{
+    return ejected_delay;
+}
+
 unsigned int NoximRouter::getFlitsCount()
 {
     unsigned count = 0;
@@ -1307,7 +1064,7 @@ int NoximRouter::getNeighborId(int _id, int direction) const
 	my_coord.x--;
 	break;
     default:
-	cout << "direction not valid : " << direction;
+	console() << "direction not valid : " << direction;
 	assert(false);
     }
 
@@ -1336,22 +1093,53 @@ void NoximRouter::ShowBuffersStats(std::ostream & out)
     buffer[i].ShowStats(out);
 }
 
-int NoximRouter::CheckFaultNeighbor(int _id)
+void NoximRouter::checkpoint(NoximCheckpoint & cp)
+{
+    // Between two cycles nothing is left deferred
+    assert(deferred.empty() && deferred_trace.empty());
+
+    for (int i = 0; i < DIRECTIONS + 1; i++)
+	buffer[i].checkpoint(cp);
+    cp.transfer(current_level_rx, DIRECTIONS + 1);
+    cp.transfer(current_level_tx, DIRECTIONS + 1);
+    cp.transfer(routed_head, DIRECTIONS + 1);
+    reservation_table.checkpoint(cp);
+    stats.checkpoint(cp);
+
+    cp.transfer(start_from_port);
+    cp.transfer(routed_flits);
+    cp.transfer(ejected_flits);
+    cp.transfer(ejected_packets);
+    cp.transfer(ejected_delay);
+    cp.transfer(local_drained);
+    cp.transfer(NoPath);
+    cp.transfer(rng);
+    cp.transfer(moved_flits);
+    cp.transfer(neighbor_faults);
+    cp.transfer(link_faults);
+}
+
+int NoximRouter::faultBit(const int direction)
 {
-   int FaultCondition=15;
-
-   for(int i=0;i<FaultRouter.size();i++)
-  {
-     if(FaultRouter[i]==getNeighborId(_id, DIRECTION_EAST)) {FaultCondition=FaultCondition&7;}
-     else if(FaultRouter[i]==getNeighborId(_id, DIRECTION_NORTH)) {FaultCondition=FaultCondition&11;}
-     else if(FaultRouter[i]==getNeighborId(_id, DIRECTION_WEST)) {FaultCondition=FaultCondition&13;}
-     else if(FaultRouter[i]==getNeighborId(_id, DIRECTION_SOUTH)) {FaultCondition=FaultCondition&14;}
-  }
-     if(getNeighborId(_id, DIRECTION_EAST)==NOT_VALID) {FaultCondition=FaultCondition&7;}
-     if(getNeighborId(_id, DIRECTION_NORTH)==NOT_VALID) {FaultCondition=FaultCondition&11;}
-     if(getNeighborId(_id, DIRECTION_WEST)==NOT_VALID) {FaultCondition=FaultCondition&13;}
-     if(getNeighborId(_id, DIRECTION_SOUTH)==NOT_VALID) {FaultCondition=FaultCondition&14;}
-  return FaultCondition;
+    static const int bits[DIRECTIONS] = { 4, 8, 1, 2 };	// N, E, S, W
+
+    return bits[direction];
+}
+
+void NoximRouter::setNeighborFault(const int direction, const bool faulty)
+{
+    if (faulty)
+	neighbor_faults |= faultBit(direction);
+    else
+	neighbor_faults &= ~faultBit(direction);
+}
+
+void NoximRouter::setLinkFault(const int direction, const bool faulty)
+{
+    if (faulty)
+	link_faults |= faultBit(direction);
+    else
+	link_faults &= ~faultBit(direction);
 }
 
 bool NoximRouter::IsSource(NoximRouteData _route_data)
@@ -11,38 +11,59 @@
 #ifndef __NOXIMROUTER_H__
 #define __NOXIMROUTER_H__
 
+#include <sstream>
 #include <systemc.h>
 #include "NoximMain.h"
+#include "NoximPort.h"
+#include "NoximFlitArena.h"
+#include "NoximPacketRegistry.h"
+#include "NoximEventLog.h"
+#include "NoximPacketTrace.h"
 #include "NoximBuffer.h"
 #include "NoximStats.h"
 #include "NoximGlobalRoutingTable.h"
 #include "NoximLocalRoutingTable.h"
 #include "NoximReservationTable.h"
+#include "NoximNegativeFirstTable.h"
 using namespace std;
 
 extern unsigned int drained_volume;
 
+// Kinds of update to the global packet bookkeeping
+enum NoximDeferredType {
+    DEFERRED_PACKET_STATE, DEFERRED_PACKET_RECEIVED, DEFERRED_FLIT_DRAINED,
+    DEFERRED_PACKET_EJECTED, DEFERRED_NO_PATH
+};
+
+// NoximDeferredUpdate -- update to the global packet bookkeeping made by
+// a router running in a worker thread, applied later in tile order
+struct NoximDeferredUpdate {
+    int type;
+    int packet_id;		// DEFERRED_PACKET_STATE and _EJECTED only
+    int state;			// DEFERRED_PACKET_STATE, or message of _NO_PATH
+};
+
 SC_MODULE(NoximRouter)
 {
 
     // I/O Ports
     sc_in_clk clock;		                  // The input clock for the router
-    sc_in <bool> reset;                           // The reset signal for the router
+    NoximIn <bool> reset;                         // The reset signal for the router
 
-    sc_in <NoximFlit> flit_rx[DIRECTIONS + 1];	  // The input channels (including local one)
-    sc_in <bool> req_rx[DIRECTIONS + 1];	  // The requests associated with the input channels
-    sc_out <bool> ack_rx[DIRECTIONS + 1];	  // The outgoing ack signals associated with the input channels
+    NoximIn <NoximFlitHandle> flit_rx[DIRECTIONS + 1];  // The input channels (including local one)
+    NoximIn <bool> req_rx[DIRECTIONS + 1];	  // The requests associated with the input channels
+    NoximOut <bool> ack_rx[DIRECTIONS + 1];	  // The outgoing ack signals associated with the input channels
 
-    sc_out <NoximFlit> flit_tx[DIRECTIONS + 1];   // The output channels (including local one)
-    sc_out <bool> req_tx[DIRECTIONS + 1];	  // The requests associated with the output channels
-    sc_in <bool> ack_tx[DIRECTIONS + 1];	  // The outgoing ack signals associated with the output channels
+    NoximOut <NoximFlitHandle> flit_tx[DIRECTIONS + 1]; // The output channels (including local one)
+    NoximOut <bool> req_tx[DIRECTIONS + 1];	  // The requests associated with the output channels
+    NoximIn <bool> ack_tx[DIRECTIONS + 1];	  // The outgoing ack signals associated with the output channels
 
-    sc_out <int> free_slots[DIRECTIONS + 1];
-    sc_in <int> free_slots_neighbor[DIRECTIONS + 1];
+    NoximOut <int> free_slots[DIRECTIONS + 1];
+    NoximIn <int> free_slots_neighbor[DIRECTIONS + 1];
 
     // Neighbor-on-Path related I/O
-    sc_out < NoximNoP_data > NoP_data_out[DIRECTIONS];
-    sc_in < NoximNoP_data > NoP_data_in[DIRECTIONS];
+    NoximOut < NoximNoP_data > NoP_data_out[DIRECTIONS];
+    NoximIn < NoximNoP_data > NoP_data_in[DIRECTIONS];
 
     // Registers
 
@@ -60,7 +81,15 @@ SC_MODULE(NoximRouter)
     NoximReservationTable reservation_table;	// Switch reservation table
     int start_from_port;	                // Port from which to start the reservation cycle
     unsigned long routed_flits;
+    unsigned long ejected_flits;	                // Flits that left the network here, warm-up included
+    unsigned long ejected_packets;	                // Head flits among them
+    double ejected_delay;		                // Sum of the delays of those head flits
     bool NoPath;
+    NoximRandom rng;		                // Random stream of the router
+    bool moved_flits;		                // A flit was received or forwarded in this cycle
+    int border_mask;		                // Neighbors inside the mesh (8 east, 4 north, 2 west, 1 south)
+    int neighbor_faults;	                // Neighbors currently faulty (same bits)
+    int link_faults;		                // Links to the neighbors currently faulty
 
     // Functions
 
@@ -73,8 +102,21 @@ SC_MODULE(NoximRouter)
 
     unsigned long getRoutedFlits();	// Returns the number of routed flits 
     unsigned int getFlitsCount();	// Returns the number of flits into the router
+    unsigned long getEjectedFlits();	// Returns the number of flits ejected to the PE
+    unsigned long getEjectedPackets();	// Returns the number of head flits ejected to the PE
+    double getEjectedDelay();		// Returns the sum of the delays of those head flits
     double getPower();		        // Returns the total power dissipated by the router
 
+    // Marks the neighbor in the given direction, or the link to it, as
+    // faulty or working
+    void setNeighborFault(const int direction, const bool faulty);
+    void setLinkFault(const int direction, const bool faulty);
+
+    // Usable neighbors: inside the mesh, not faulty and with a working link
+    inline int CheckFaultNeighbor() const {
+	return border_mask & ~(neighbor_faults | link_faults);
+    }
+
     // Constructor
 
     SC_CTOR(NoximRouter) {
@@ -99,7 +141,7 @@ SC_MODULE(NoximRouter)
     // wrappers
     int selectionFunction(const vector <int> &directions,
 			  const NoximRouteData & route_data);
-    vector < int >routingFunction(const NoximRouteData & route_data,NoximFlit flit);
+    vector < int >routingFunction(const NoximRouteData & route_data, const NoximFlit & flit);
 
     // selection strategies
     int selectionRandom(const vector <int> & directions);
@@ -130,27 +172,52 @@ SC_MODULE(NoximRouter)
 				    const NoximCoord & current,
 				    const NoximCoord & destination);
     vector < int >routingNegativeFirstFaultTolerance(const NoximCoord & current,
-				                     const NoximCoord & destination, NoximFlit flit);
+				                     const NoximCoord & destination, const NoximFlit & flit);
     NoximNoP_data getCurrentNoPData() const;
     void NoP_report() const;
     int NoPScore(const NoximNoP_data & nop_data, const vector <int> & nop_channels) const;
     int reflexDirection(int direction) const;
     int getNeighborId(int _id, int direction) const;
     bool inCongestion();
-    int CheckFaultNeighbor(int _id);
+    static int faultBit(const int direction);	// Bit of a direction in the masks
     bool IsSource(NoximRouteData _route_data);
-    vector < int > EastBuffer;
-    vector < int > WestBuffer;
-    vector < int > NorthBuffer;
-    vector < int > SouthBuffer;
-    vector < int > LocalBuffer;
+    NoximFlit routed_head[DIRECTIONS + 1];	// Last head flit routed from each input
+
+    bool defer_globals;
+    vector < NoximDeferredUpdate > deferred;
+    vector < NoximTraceRecord > deferred_trace;
+    mutable ostringstream deferred_output;
+
+    ostream & console() const;	// Where the router prints its messages
+    void setPacketState(const int packet_id, const int state);
+    void packetReceived();
+    void packetEjected(const int packet_id);
+    void logNoPath(const int message);
+    void traceFlit(const NoximFlit & flit, const int output);
+    void flitDrained();
     
 
   public:
 
     unsigned int local_drained;
 
+    // While set, updates to the global packet bookkeeping and console
+    // output are kept aside until commitDeferred() applies them
+    void setDeferGlobals(const bool defer);
+    void commitDeferred();
+
+    // Idle cycle fast-forward of the native engine: the router moved no
+    // flit in the last cycle and has nothing buffered
+    bool isIdle() const;
+    // Account 'cycles' idle cycles without evaluating them
+    void skipIdleCycles(const int cycles);
+    // Same for cycles with reset asserted
+    void skipResetCycles(const int cycles);
+
     void ShowBuffersStats(std::ostream & out);
+
+    // Saves the state of the router between two cycles, or restores it
+    void checkpoint(NoximCheckpoint & cp);
 };
 
 #endif
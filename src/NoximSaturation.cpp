@@ -0,0 +1,155 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the saturation search
+ */
+
+#include <algorithm>
+#include "NoximSaturation.h"
+
+static bool lowerPir(const NoximSaturationTrial & a,
+		     const NoximSaturationTrial & b)
+{
+    return a.pir < b.pir;
+}
+
+NoximSaturationSearch::NoximSaturationSearch(NoximNoC * _noc,
+					     NoximNativeEngine * _engine)
+{
+    noc = _noc;
+    engine = _engine;
+
+    // Timed fault events change FaultRouter during a trial
+    faults = FaultRouter;
+
+    // The burstiness of the traffic is kept at every rate
+    retransmission_ratio = NoximGlobalParams::probability_of_retransmission /
+	NoximGlobalParams::packet_injection_rate;
+    delay_limit = 0.0;
+}
+
+void NoximSaturationSearch::trial(const double pir,
+				  NoximSaturationTrial & result)
+{
+    NoximGlobalParams::packet_injection_rate = pir;
+    NoximGlobalParams::probability_of_retransmission =
+	retransmission_ratio * pir;
+
+    FaultRouter = faults;
+    noc->restart();
+    engine->reset(DEFAULT_RESET_TIME);
+
+    NoximGlobalStats gs(noc);
+    int simulated = 0;
+    bool diverged = false;
+
+    while (simulated < NoximGlobalParams::simulation_time && !native_stop) {
+	int cycles = min(SATURATION_CHECK_CYCLES,
+			 NoximGlobalParams::simulation_time - simulated);
+
+	engine->run(cycles);
+	simulated += cycles;
+
+	// Only packets received after the warm-up are counted, and enough
+	// of them that a few slow ones cannot stop the trial
+	if (delay_limit > 0.0 &&
+	    gs.getReceivedPackets() >= SATURATION_MIN_PACKETS &&
+	    gs.getAverageDelay() > delay_limit) {
+	    diverged = true;
+	    break;
+	}
+    }
+
+    // The throughput of a stopped trial is that of the cycles simulated
+    int simulation_time = NoximGlobalParams::simulation_time;
+
+    NoximGlobalParams::simulation_time = simulated;
+    result.pir = NoximGlobalParams::packet_injection_rate;
+    gs.getDigest(result.digest);
+    NoximGlobalParams::simulation_time = simulation_time;
+
+    result.saturated = diverged || gs.getReceivedPackets() == 0 ||
+	(delay_limit > 0.0 && result.digest.average_delay > delay_limit);
+}
+
+void NoximSaturationSearch::showRow(ostream & out,
+				    const NoximSaturationTrial & result) const
+{
+    const NoximStatsDigest & digest = result.digest;
+
+    out << result.pir
+	<< " " << digest.average_delay
+	<< " " << digest.max_delay
+	<< " " << digest.throughput
+	<< " " << digest.received_packets
+	<< " " << digest.cycles
+	<< " " << (result.saturated ? 1 : 0) << endl;
+}
+
+bool NoximSaturationSearch::run(ostream & out)
+{
+    NoximSaturationTrial result;
+
+    out << "% pir avg_delay max_delay throughput received cycles saturated"
+	<< endl;
+
+    // Zero-load delay, without any limit
+    trial(NoximGlobalParams::saturation_min_pir, result);
+    showRow(out, result);
+    if (result.saturated) {
+	cerr << "Error: no packet received after the warm-up at the minimum injection rate" << endl;
+	return false;
+    }
+    trials.push_back(result);
+
+    double zero_load_delay = result.digest.average_delay;
+    delay_limit = NoximGlobalParams::saturation_factor * zero_load_delay;
+
+    double low = NoximGlobalParams::saturation_min_pir;
+    double high = NoximGlobalParams::saturation_max_pir;
+
+    trial(high, result);
+    showRow(out, result);
+    trials.push_back(result);
+
+    bool saturated = result.saturated;
+    if (saturated)
+	for (int step = 0; step < SATURATION_STEPS; step++) {
+	    double pir = (low + high) / 2.0;
+
+	    trial(pir, result);
+	    showRow(out, result);
+	    trials.push_back(result);
+
+	    if (result.saturated)
+		high = pir;
+	    else
+		low = pir;
+	}
+
+    out << "% zero-load delay (cycles): " << zero_load_delay << endl;
+    out << "% saturation delay (cycles): " << delay_limit << endl;
+    if (saturated) {
+	out << "% saturation pir: " << (float) low << endl;
+	out << "% lowest saturating pir: " << (float) high << endl;
+    } else
+	out << "% no saturation up to pir: " << (float) high << endl;
+
+    // Delay and throughput of the rates that do not saturate
+    sort(trials.begin(), trials.end(), lowerPir);
+
+    out << endl << "% pir avg_delay throughput" << endl;
+    out << "curve = [" << endl;
+    for (unsigned int i = 0; i < trials.size(); i++)
+	if (!trials[i].saturated)
+	    out << "   " << trials[i].pir
+		<< " " << trials[i].digest.average_delay
+		<< " " << trials[i].digest.throughput << endl;
+    out << "];" << endl;
+
+    return true;
+}
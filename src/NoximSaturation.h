@@ -0,0 +1,78 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the saturation search
+ */
+
+#ifndef __NOXIMSATURATION_H__
+#define __NOXIMSATURATION_H__
+
+#include <iostream>
+#include <vector>
+#include "NoximMain.h"
+#include "NoximNoC.h"
+#include "NoximNativeEngine.h"
+#include "NoximGlobalStats.h"
+using namespace std;
+
+// Halvings of the interval between the minimum and maximum rates
+#define SATURATION_STEPS           8
+
+// Cycles simulated between two checks of the average delay of a trial
+#define SATURATION_CHECK_CYCLES    100
+
+// Packets received after the warm-up before a trial can be stopped
+#define SATURATION_MIN_PACKETS     100
+
+// NoximSaturationTrial -- outcome of the run at one injection rate
+struct NoximSaturationTrial {
+    float pir;
+    bool saturated;		// Delay past the limit, or nothing received
+    NoximStatsDigest digest;
+};
+
+// NoximSaturationSearch -- finds the packet injection rate at which the
+// NoC saturates by bisection, simulating the same elaborated NoC once per
+// rate like a fault campaign does with its fault sets.
+//
+// Every trial lasts the -sim cycles, without the packet cap, so that all
+// of them are measured over the same window after the warm-up. The
+// minimum rate gives the zero-load delay. A rate saturates the NoC when
+// the average delay goes past 'factor' times the zero-load delay; once
+// SATURATION_MIN_PACKETS packets have been received after the warm-up,
+// the trial is stopped as soon as this happens, since the rest of the run
+// would only make the delay grow. The maximum rate is tried next, then
+// the interval between the highest rate that does not saturate and the
+// lowest one that does is halved SATURATION_STEPS times.
+class NoximSaturationSearch {
+
+  public:
+
+    NoximSaturationSearch(NoximNoC * _noc, NoximNativeEngine * _engine);
+
+    // Runs the trials and shows the curve up to saturation. Returns false
+    // if no delay can be measured at the minimum rate
+    bool run(ostream & out);
+
+  private:
+
+    NoximNoC *noc;
+    NoximNativeEngine *engine;
+
+    vector < int >faults;	// Faulty routers at the start of every trial
+    double retransmission_ratio;	// Probability of retransmission / pir
+    double delay_limit;		// Average delay beyond which the NoC saturates
+
+    vector < NoximSaturationTrial > trials;
+
+    // Simulates from time zero at the given rate
+    void trial(const double pir, NoximSaturationTrial & result);
+
+    void showRow(ostream & out, const NoximSaturationTrial & result) const;
+};
+
+#endif
@@ -0,0 +1,85 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the periodic metrics snapshots
+ */
+
+#include <cstring>
+#include "NoximSnapshot.h"
+
+NoximSnapshotFile::NoximSnapshotFile()
+{
+    file = NULL;
+    interval = 0;
+    tiles = 0;
+    next_cycle = 0;
+    memset(&previous, 0, sizeof(previous));
+}
+
+NoximSnapshotFile::~NoximSnapshotFile()
+{
+    close();
+}
+
+bool NoximSnapshotFile::open(const char *fname, const int _interval,
+			     const int _tiles)
+{
+    close();
+
+    file = fopen(fname, "w");
+    if (file == NULL)
+	return false;
+
+    interval = _interval;
+    tiles = _tiles;
+    next_cycle = interval;
+    memset(&previous, 0, sizeof(previous));
+
+    fprintf(file, "cycle,flits_in_buffers,buffer_occupancy,"
+	    "reserved_outputs,throughput,sent_packets,received_packets,"
+	    "no_path_packets\n");
+
+    return true;
+}
+
+void NoximSnapshotFile::close()
+{
+    if (file == NULL)
+	return;
+
+    fclose(file);
+    file = NULL;
+}
+
+// buffer_occupancy: mean flits per input buffer. reserved_outputs:
+// fraction of the valid output ports reserved. throughput: flits
+// ejected per cycle per tile over the window. The packet counts are
+// those of the window
+void NoximSnapshotFile::write(const NoximSnapshot & snapshot)
+{
+    int window = snapshot.cycle - previous.cycle;
+
+    fprintf(file, "%d,%u,%g,%g,%g,%d,%d,%d\n",
+	    snapshot.cycle, snapshot.flits_in_buffers,
+	    snapshot.buffers ? (double) snapshot.flits_in_buffers /
+	    snapshot.buffers : 0.0,
+	    snapshot.valid_outputs ? (double) snapshot.reserved_outputs /
+	    snapshot.valid_outputs : 0.0,
+	    window > 0 ? (double) (snapshot.ejected_flits -
+				   previous.ejected_flits) / window /
+	    tiles : 0.0,
+	    (int) (snapshot.sent_packets - previous.sent_packets),
+	    (int) (snapshot.received_packets - previous.received_packets),
+	    (int) (snapshot.no_path_packets - previous.no_path_packets));
+
+    // Readable while the simulation goes on
+    fflush(file);
+
+    previous = snapshot;
+    while (next_cycle <= snapshot.cycle)
+	next_cycle += interval;
+}
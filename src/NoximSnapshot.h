@@ -0,0 +1,71 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2010 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the periodic metrics snapshots
+ */
+
+#ifndef __NOXIMSNAPSHOT_H__
+#define __NOXIMSNAPSHOT_H__
+
+#include <cstdio>
+using namespace std;
+
+// NoximSnapshot -- state of the NoC at the end of a window of cycles. The
+// counters are cumulative since time zero
+struct NoximSnapshot {
+    int cycle;
+    unsigned int flits_in_buffers;	// Flits in the router buffers
+    unsigned int buffers;		// Input buffers of the routers
+    unsigned int reserved_outputs;	// Output ports connected to an input
+    unsigned int valid_outputs;		// Output ports that can be reserved
+    unsigned long ejected_flits;	// Flits that left the network
+    unsigned int sent_packets;
+    unsigned int received_packets;
+    unsigned int no_path_packets;
+};
+
+// NoximSnapshotFile -- one CSV line every 'interval' cycles, with the
+// instantaneous figures of the snapshot and the rates over the window
+// since the previous one. The lines are written as the simulation runs,
+// so transients can be followed while it is still going.
+class NoximSnapshotFile {
+
+  public:
+
+    NoximSnapshotFile();
+    ~NoximSnapshotFile();
+
+    // Create the file and write the header line. Returns false if the
+    // file cannot be created
+    bool open(const char *fname, const int _interval, const int _tiles);
+
+    void close();
+
+    inline bool enabled() const {
+	return file != NULL;
+    }
+
+    // Cycle of the next snapshot
+    inline int nextCycle() const {
+	return next_cycle;
+    }
+
+    void write(const NoximSnapshot & snapshot);
+
+  private:
+
+    FILE *file;
+    int interval;
+    int tiles;
+    int next_cycle;
+    NoximSnapshot previous;	// Counters at the end of the last window
+
+    NoximSnapshotFile(const NoximSnapshotFile &);
+    NoximSnapshotFile & operator=(const NoximSnapshotFile &);
+};
+
+#endif
@@ -8,6 +8,7 @@
  * This file contains the implementation of the statistics
  */
 
+#include <cmath>
 #include "NoximStats.h"
 
 // TODO: nan in averageDelay
@@ -16,6 +17,46 @@ void NoximStats::configure(const int node_id, const double _warm_up_time)
 {
     id = node_id;
     warm_up_time = _warm_up_time;
+    chist.clear();
+    chist_index.assign(NoximGlobalParams::mesh_dim_x *
+		       NoximGlobalParams::mesh_dim_y, -1);
+    delay_histogram.clear();
+    power.Reset();
+}
+
+void NoximStats::restart(const double _warm_up_time)
+{
+    warm_up_time = _warm_up_time;
+    chist.clear();
+    chist_index.assign(chist_index.size(), -1);
+    delay_histogram.clear();
+}
+
+void NoximStats::checkpoint(NoximCheckpoint & cp)
+{
+    // Field by field: the padding of CommHistory is not part of the state
+    unsigned long long n = chist.size();
+
+    cp.transfer(n);
+    if (cp.isRestoring())
+	chist.assign(cp.good() && n <= chist_index.size() ? n : 0,
+		     CommHistory());
+    for (unsigned int i = 0; i < chist.size(); i++) {
+	CommHistory & ch = chist[i];
+
+	cp.transfer(ch.src_id);
+	cp.transfer(ch.received_packets);
+	cp.transfer(ch.delay_sum);
+	cp.transfer(ch.delay_sum_squares);
+	cp.transfer(ch.min_delay);
+	cp.transfer(ch.max_delay);
+	cp.transfer(ch.total_received_flits);
+	cp.transfer(ch.last_received_flit_time);
+    }
+    cp.transfer(chist_index);
+    delay_histogram.checkpoint(cp);
+    cp.transfer(warm_up_time);
+    power.checkpoint(cp);
 }
 
 void NoximStats::receivedFlit(const double arrival_time,
@@ -29,17 +70,34 @@ void NoximStats::receivedFlit(const double arrival_time,
     if (i == -1) {
 	// first flit received from a given source
 	// initialize CommHist structure
-	CommHistory ch;
+	CommHistory ch = CommHistory();
 
 	ch.src_id = flit.src_id;
+	ch.received_packets = 0;
+	ch.delay_sum = 0.0;
+	ch.delay_sum_squares = 0.0;
+	ch.min_delay = -1.0;
+	ch.max_delay = -1.0;
 	ch.total_received_flits = 0;
 	chist.push_back(ch);
 
 	i = chist.size() - 1;
+	chist_index[flit.src_id] = i;
     }
 
-    if (flit.flit_type == FLIT_TYPE_HEAD) //
-	chist[i].delays.push_back(arrival_time - flit.timestamp);
+    if (flit.flit_type == FLIT_TYPE_HEAD) {
+	CommHistory & ch = chist[i];
+	double delay = arrival_time - flit.timestamp;
+
+	if (ch.received_packets == 0 || delay < ch.min_delay)
+	    ch.min_delay = delay;
+	if (delay > ch.max_delay)
+	    ch.max_delay = delay;
+	ch.received_packets++;
+	ch.delay_sum += delay;
+	ch.delay_sum_squares += delay * delay;
+	delay_histogram.record(delay);
+    }
 
     chist[i].total_received_flits++;
     chist[i].last_received_flit_time = arrival_time - warm_up_time;
@@ -47,16 +105,11 @@ void NoximStats::receivedFlit(const double arrival_time,
 
 double NoximStats::getAverageDelay(const int src_id)
 {
-    double sum = 0.0;
-
     int i = searchCommHistory(src_id);
 
     assert(i >= 0);
 
-    for (unsigned int j = 0; j < chist[i].delays.size(); j++)
-	sum += chist[i].delays[j];
-
-    return sum / (double) chist[i].delays.size();
+    return chist[i].delay_sum / (double) chist[i].received_packets;
 }
 
 double NoximStats::getAverageDelay()
@@ -64,7 +117,7 @@ double NoximStats::getAverageDelay()
     double avg = 0.0;
 
     for (unsigned int k = 0; k < chist.size(); k++) {
-	unsigned int samples = chist[k].delays.size();
+	unsigned int samples = chist[k].received_packets;
 	if (samples)
 	    avg += (double) samples *getAverageDelay(chist[k].src_id);
     }
@@ -74,36 +127,51 @@ double NoximStats::getAverageDelay()
 
 double NoximStats::getMaxDelay(const int src_id)
 {
-    double maxd = -1.0;
-
     int i = searchCommHistory(src_id);
 
     assert(i >= 0);
 
-    for (unsigned int j = 0; j < chist[i].delays.size(); j++)
-	if (chist[i].delays[j] > maxd) {
-	    //      cout << src_id << " -> " << id << ": " << chist[i].delays[j] << endl;
-	    maxd = chist[i].delays[j];
-	}
-    return maxd;
+    return chist[i].max_delay;
 }
 
 double NoximStats::getMaxDelay()
 {
     double maxd = -1.0;
 
-    for (unsigned int k = 0; k < chist.size(); k++) {
-	unsigned int samples = chist[k].delays.size();
-	if (samples) {
-	    double m = getMaxDelay(chist[k].src_id);
-	    if (m > maxd)
-		maxd = m;
-	}
-    }
+    for (unsigned int k = 0; k < chist.size(); k++)
+	if (chist[k].max_delay > maxd)
+	    maxd = chist[k].max_delay;
 
     return maxd;
 }
 
+double NoximStats::getMinDelay(const int src_id)
+{
+    int i = searchCommHistory(src_id);
+
+    assert(i >= 0);
+
+    return chist[i].min_delay;
+}
+
+double NoximStats::getDelayStdDev(const int src_id)
+{
+    int i = searchCommHistory(src_id);
+
+    assert(i >= 0);
+
+    const CommHistory & ch = chist[i];
+
+    if (ch.received_packets == 0)
+	return -1.0;
+
+    double mean = ch.delay_sum / (double) ch.received_packets;
+    double variance =
+	ch.delay_sum_squares / (double) ch.received_packets - mean * mean;
+
+    return variance > 0.0 ? sqrt(variance) : 0.0;
+}
+
 double NoximStats::getAverageThroughput(const int src_id)
 {
     int i = searchCommHistory(src_id);
@@ -135,7 +203,7 @@ unsigned int NoximStats::getReceivedPackets()
     int n = 0;
 
     for (unsigned int i = 0; i < chist.size(); i++)
-	n += chist[i].delays.size();
+	n += chist[i].received_packets;
 
     return n;
 }
@@ -182,11 +250,10 @@ double NoximStats::getCommunicationEnergy(int src_id, int dst_id)
 
 int NoximStats::searchCommHistory(int src_id)
 {
-    for (unsigned int i = 0; i < chist.size(); i++)
-	if (chist[i].src_id == src_id)
-	    return i;
+    if (src_id < 0 || src_id >= (int) chist_index.size())
+	return -1;
 
-    return -1;
+    return chist_index[src_id];
 }
 
 void NoximStats::showStats(int curr_node, std::ostream & out, bool header)
@@ -197,6 +264,8 @@ void NoximStats::showStats(int curr_node, std::ostream & out, bool header)
 	    << setw(5) << "dst"
 	    << setw(10) << "delay avg"
 	    << setw(10) << "delay max"
+	    << setw(10) << "delay min"
+	    << setw(10) << "delay std"
 	    << setw(15) << "throughput"
 	    << setw(13) << "energy"
 	    << setw(12) << "received" << setw(12) << "received" << endl;
@@ -205,6 +274,8 @@ void NoximStats::showStats(int curr_node, std::ostream & out, bool header)
 	    << setw(5) << ""
 	    << setw(10) << "cycles"
 	    << setw(10) << "cycles"
+	    << setw(10) << "cycles"
+	    << setw(10) << "cycles"
 	    << setw(15) << "flits/cycle"
 	    << setw(13) << "Joule"
 	    << setw(12) << "packets" << setw(12) << "flits" << endl;
@@ -215,10 +286,12 @@ void NoximStats::showStats(int curr_node, std::ostream & out, bool header)
 	    << setw(5) << curr_node
 	    << setw(10) << getAverageDelay(chist[i].src_id)
 	    << setw(10) << getMaxDelay(chist[i].src_id)
+	    << setw(10) << getMinDelay(chist[i].src_id)
+	    << setw(10) << getDelayStdDev(chist[i].src_id)
 	    << setw(15) << getAverageThroughput(chist[i].src_id)
 	    << setw(13) << getCommunicationEnergy(chist[i].src_id,
 						  curr_node)
-	    << setw(12) << chist[i].delays.size()
+	    << setw(12) << chist[i].received_packets
 	    << setw(12) << chist[i].total_received_flits << endl;
     }
 
@@ -16,11 +16,20 @@
 #include <vector>
 #include "NoximMain.h"
 #include "NoximPower.h"
+#include "NoximHistogram.h"
+#include "NoximCheckpoint.h"
 using namespace std;
 
+// CommHistory -- running aggregates of the communication from one source:
+// the delays of the head flits are not kept, so the memory of a flow does
+// not grow with the length of the simulation
 struct CommHistory {
     int src_id;
-     vector < double >delays;
+    unsigned int received_packets;	// Head flits, one delay each
+    double delay_sum;
+    double delay_sum_squares;
+    double min_delay;
+    double max_delay;
     unsigned int total_received_flits;
     double last_received_flit_time;
 };
@@ -34,6 +43,13 @@ class NoximStats {
 
     void configure(const int node_id, const double _warm_up_time);
 
+    // Forgets the flits received so far and moves the end of the
+    // warm-up to '_warm_up_time'
+    void restart(const double _warm_up_time);
+
+    // Saves the aggregates, the histogram and the energy, or restores them
+    void checkpoint(NoximCheckpoint & cp);
+
     // Access point for stats update
     void receivedFlit(const double arrival_time, const NoximFlit & flit);
 
@@ -51,6 +67,20 @@ class NoximStats {
     // Returns the max delay (cycles) for the current node
     double getMaxDelay();
 
+    // Returns the min delay for the current node as regards the
+    // communication whose source node is src_id
+    double getMinDelay(const int src_id);
+
+    // Returns the standard deviation of the delay (cycles) for the
+    // current node as regards the communication whose source is src_id
+    double getDelayStdDev(const int src_id);
+
+    // Returns the histogram of the delays (cycles) of the packets
+    // received by the current node
+    const NoximHistogram & getDelayHistogram() const {
+	return delay_histogram;
+    }
+
     // Returns the average throughput (flits/cycle) for the current node
     // and for the communication whose source is src_id
     double getAverageThroughput(const int src_id);
@@ -85,7 +115,9 @@ class NoximStats {
   private:
 
     int id;
-    vector < CommHistory > chist;
+    vector < CommHistory > chist;	// In order of first arrival
+    vector < int >chist_index;	// Entry in chist of each source, or -1
+    NoximHistogram delay_histogram;
     double warm_up_time;
 
     int searchCommHistory(int src_id);